@@ -28,7 +28,12 @@
 /* TODO: add minimal stack size configuration macro definition      */
 #define configMINIMAL_STACK_SIZE                256
 /* TODO: add total heap size configuration macro definition         */
-#define configTOTAL_HEAP_SIZE                   10240
+/* every TCB carries its own struct _reent (~1 KB) with newlib reentrancy on */
+#define configTOTAL_HEAP_SIZE                   24576
+
+/* Give each task its own newlib _reent so printf, errno and strtok state
+are not shared; malloc is serialized by __malloc_lock in syscall_stubs.c. */
+#define configUSE_NEWLIB_REENTRANT              1
 
 /* Memory allocation related definitions. */
 #define configSUPPORT_STATIC_ALLOCATION         0
@@ -57,6 +62,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil             0
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
 
 #ifdef __NVIC_PRIO_BITS
     #define configPRIO_BITS         __NVIC_PRIO_BITS
@@ -72,10 +78,30 @@ to exclude the API function. */
 See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    ( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
 
+#ifndef HOST_SIM
+
 #define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); for( ;; );}
 
 #define vPortSVCHandler     SVC_Handler
 #define xPortPendSVHandler  PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
 
+#else /* HOST_SIM */
+
+/* make host: the same firmware on the POSIX port, see sim/. Every task is
+a pthread running on its FreeRTOS stack, so stacks need more than
+PTHREAD_STACK_MIN (16 KB) and the heap grows to match; glibc is reentrant
+on its own. */
+#undef configMINIMAL_STACK_SIZE
+#define configMINIMAL_STACK_SIZE                ( 32768 / sizeof( StackType_t ) )
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                   ( 1024 * 1024 )
+#undef configUSE_NEWLIB_REENTRANT
+#define configUSE_NEWLIB_REENTRANT              0
+
+void sim_assert_failed( const char *file, int line );
+#define configASSERT( x ) if ((x) == 0) {sim_assert_failed( __FILE__, __LINE__ );}
+
+#endif /* HOST_SIM */
+
 #endif /* _FREERTOS_CONFIG_H_ */
@@ -9,8 +9,13 @@
 #ifndef _ARM_H_
 #define _ARM_H_
 
+#include <stdint.h>
+#include <stddef.h>
+
 #define intrinsic __attribute__( ( always_inline ) ) static inline
 
+#ifndef HOST_SIM
+
 /**
  * @brief      Sets a breakpoint.
  */
@@ -18,6 +23,182 @@ intrinsic void breakpoint( void ) {
   __asm volatile( "bkpt" );
 }
 
+/**
+ * @brief      Load-exclusive word, arms the local monitor for addr.
+ */
+intrinsic uint32_t ldrex( volatile uint32_t *addr ) {
+  uint32_t val;
+  __asm volatile( "ldrex %0, [%1]" : "=r" ( val ) : "r" ( addr ) : "memory" );
+  return val;
+}
+
+/**
+ * @brief      Store-exclusive word.
+ *
+ * @return     0 if the store happened, 1 if the monitor was lost (another
+ *             exclusive access or an exception) and the caller must retry.
+ */
+intrinsic uint32_t strex( uint32_t val, volatile uint32_t *addr ) {
+  uint32_t failed;
+  __asm volatile( "strex %0, %2, [%1]" : "=&r" ( failed ) : "r" ( addr ), "r" ( val ) : "memory" );
+  return failed;
+}
+
+/**
+ * @brief      Load-exclusive halfword.
+ */
+intrinsic uint16_t ldrexh( volatile uint16_t *addr ) {
+  uint32_t val;
+  __asm volatile( "ldrexh %0, [%1]" : "=r" ( val ) : "r" ( addr ) : "memory" );
+  return ( uint16_t )val;
+}
+
+/**
+ * @brief      Store-exclusive halfword, same return convention as strex.
+ */
+intrinsic uint32_t strexh( uint16_t val, volatile uint16_t *addr ) {
+  uint32_t failed;
+  __asm volatile( "strexh %0, %2, [%1]" : "=&r" ( failed ) : "r" ( addr ), "r" ( ( uint32_t )val ) : "memory" );
+  return failed;
+}
+
+/**
+ * @brief      Drops the local monitor after an ldrex that is not followed by strex.
+ */
+intrinsic void clrex( void ) {
+  __asm volatile( "clrex" ::: "memory" );
+}
+
+/**
+ * @brief      Data memory barrier.
+ */
+intrinsic void dmb( void ) {
+  __asm volatile( "dmb" ::: "memory" );
+}
+
+/**
+ * @brief      Data synchronization barrier.
+ */
+intrinsic void dsb( void ) {
+  __asm volatile( "dsb" ::: "memory" );
+}
+
+/**
+ * @brief      Number of the running exception, 16 + n for IRQn, 0 in thread mode.
+ */
+intrinsic uint32_t ipsr( void ) {
+  uint32_t val;
+  __asm volatile( "mrs %0, ipsr" : "=r" ( val ) );
+  return val;
+}
+
+/**
+ * @brief      Masks every configurable interrupt, priority 0 included, unlike
+ *             the kernel's BASEPRI mask.
+ *
+ * @return     The PRIMASK to hand back to irq_restore.
+ */
+intrinsic uint32_t irq_save( void ) {
+  uint32_t primask;
+  __asm volatile( "mrs %0, primask\n\tcpsid i" : "=r" ( primask ) :: "memory" );
+  return primask;
+}
+
+/**
+ * @brief      Restores the PRIMASK irq_save returned.
+ */
+intrinsic void irq_restore( uint32_t primask ) {
+  __asm volatile( "msr primask, %0" :: "r" ( primask ) : "memory" );
+}
+
+#else /* HOST_SIM */
+
+#include <pthread.h>
+#include <signal.h>
+
+/*
+ * Host build (make host): the exclusive monitor is emulated with a
+ * compare-and-swap against the value ldrex saw, one monitor per thread.
+ * Exception entry clears it, like the real one (see sim/sim_core.c).
+ */
+struct arm_monitor {
+  volatile void *addr;
+  uint32_t val;
+};
+extern __thread struct arm_monitor arm_monitor;
+/* the exception the simulated core is running, see sim/sim_core.c */
+extern volatile uint32_t arm_ipsr;
+/* the exception frame the interrupted code stacked; the sim fills in only
+   the PC, arm_frame[6], from the signal context */
+extern volatile uint32_t arm_frame[8];
+
+intrinsic void breakpoint( void ) {
+  __builtin_trap();
+}
+
+intrinsic uint32_t ldrex( volatile uint32_t *addr ) {
+  uint32_t val = __atomic_load_n( addr, __ATOMIC_SEQ_CST );
+  arm_monitor.addr = addr;
+  arm_monitor.val = val;
+  return val;
+}
+
+intrinsic uint32_t strex( uint32_t val, volatile uint32_t *addr ) {
+  uint32_t expected = arm_monitor.val;
+  int armed = ( arm_monitor.addr == addr );
+  arm_monitor.addr = NULL;
+  return !( armed && __atomic_compare_exchange_n( addr, &expected, val, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) );
+}
+
+intrinsic uint16_t ldrexh( volatile uint16_t *addr ) {
+  uint16_t val = __atomic_load_n( addr, __ATOMIC_SEQ_CST );
+  arm_monitor.addr = addr;
+  arm_monitor.val = val;
+  return val;
+}
+
+intrinsic uint32_t strexh( uint16_t val, volatile uint16_t *addr ) {
+  uint16_t expected = ( uint16_t )arm_monitor.val;
+  int armed = ( arm_monitor.addr == addr );
+  arm_monitor.addr = NULL;
+  return !( armed && __atomic_compare_exchange_n( addr, &expected, val, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) );
+}
+
+intrinsic void clrex( void ) {
+  arm_monitor.addr = NULL;
+}
+
+intrinsic void dmb( void ) {
+  __atomic_thread_fence( __ATOMIC_SEQ_CST );
+}
+
+intrinsic void dsb( void ) {
+  __atomic_thread_fence( __ATOMIC_SEQ_CST );
+}
+
+intrinsic uint32_t ipsr( void ) {
+  return arm_ipsr;
+}
+
+/* an interrupt is a signal to the task's thread (sim/sim_core.c): blocking
+   them all is PRIMASK, and handlers already run with them blocked */
+intrinsic uint32_t irq_save( void ) {
+  sigset_t all, old;
+  sigfillset( &all );
+  pthread_sigmask( SIG_BLOCK, &all, &old );
+  return sigismember( &old, SIGUSR2 );
+}
+
+intrinsic void irq_restore( uint32_t primask ) {
+  if ( !primask ) {
+    sigset_t all;
+    sigfillset( &all );
+    pthread_sigmask( SIG_UNBLOCK, &all, NULL );
+  }
+}
+
+#endif /* HOST_SIM */
+
 #undef intrinsic
 
 #endif /* _ARM_H_ */
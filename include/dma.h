@@ -0,0 +1,63 @@
+#ifndef _DMA_H_
+#define _DMA_H_
+
+#include <stdint.h>
+
+/** @brief DMA stream configuration register (SxCR) bits */
+#define DMA_SxCR_EN         (1 << 0)
+#define DMA_SxCR_DMEIE      (1 << 1)
+#define DMA_SxCR_TEIE       (1 << 2)
+#define DMA_SxCR_HTIE       (1 << 3)
+#define DMA_SxCR_TCIE       (1 << 4)
+#define DMA_SxCR_DIR_P2M    (0 << 6)
+#define DMA_SxCR_DIR_M2P    (1 << 6)
+#define DMA_SxCR_CIRC       (1 << 8)
+#define DMA_SxCR_MINC       (1 << 10)
+#define DMA_SxCR_PL_HIGH    (2 << 16)
+#define DMA_SxCR_CHSEL_POS  25
+
+/** @brief Per-stream interrupt flags, normalised to stream 0's bit positions */
+#define DMA_FEIF            (1 << 0)
+#define DMA_DMEIF           (1 << 2)
+#define DMA_TEIF            (1 << 3)
+#define DMA_HTIF            (1 << 4)
+#define DMA_TCIF            (1 << 5)
+#define DMA_ALL_FLAGS       (DMA_FEIF | DMA_DMEIF | DMA_TEIF | DMA_HTIF | DMA_TCIF)
+
+/** @brief DMA1 stream IRQ numbers (streams 0-6 are contiguous, 7 is not) */
+#define DMA1_STREAM0_INT_NUM 11
+#define DMA1_STREAM7_INT_NUM 47
+
+/**
+ * @brief Configure a stream for a peripheral; the stream is left disabled
+ *
+ * @param dma         - 1 or 2
+ * @param stream      - 0 to 7
+ * @param channel     - request channel (CHSEL) from the RM0368 mapping table
+ * @param periph_addr - address of the peripheral data register
+ * @param cr          - DMA_SxCR_* flags (direction, increment, interrupts)
+ */
+void dma_stream_init(int dma, int stream, uint32_t channel, volatile void *periph_addr, uint32_t cr);
+
+/*
+ * Point the stream at a memory span and enable it
+ */
+void dma_stream_start(int dma, int stream, volatile void *mem, uint16_t len);
+
+/*
+ * Disable the stream and wait until the hardware has released it
+ */
+void dma_stream_stop(int dma, int stream);
+
+/*
+ * Items left to transfer (NDTR)
+ */
+uint16_t dma_stream_remaining(int dma, int stream);
+
+/*
+ * Read / clear the DMA_*IF flags of a stream
+ */
+uint32_t dma_get_flags(int dma, int stream);
+void dma_clear_flags(int dma, int stream, uint32_t flags);
+
+#endif /* _DMA_H_ */
@@ -0,0 +1,48 @@
+/**
+ * @file   dwt.h
+ *
+ * @brief  DWT cycle counter, for timing code in CPU cycles
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+#ifndef _DWT_H_
+#define _DWT_H_
+
+#include <stdint.h>
+#include <mmio.h>
+
+#define DEMCR               (volatile uint32_t *) 0xE000EDFC
+#define DEMCR_TRCENA        (1 << 24)
+#define DWT_CTRL            (volatile uint32_t *) 0xE0001000
+#define DWT_CTRL_CYCCNTENA  (1 << 0)
+#define DWT_CYCCNT          (volatile uint32_t *) 0xE0001004
+
+/**
+ * @brief  Powers up the trace block and starts CYCCNT. Idempotent.
+ */
+static inline void dwt_init( void ) {
+  *DEMCR |= DEMCR_TRCENA;
+  *DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+/**
+ * @brief  Restarts CYCCNT from 0.
+ */
+static inline void dwt_reset( void ) {
+  *DWT_CYCCNT = 0;
+  MMIO_WRITTEN( *DWT_CYCCNT );
+}
+
+/**
+ * @brief  Current cycle count, wraps every 2^32 cycles (~268 s at 16 MHz).
+ *         In the host build the read first brings the simulated counter up
+ *         to the host clock, so it counts host time at 16 MHz.
+ */
+static inline uint32_t dwt_cycles( void ) {
+  MMIO_READ( *DWT_CYCCNT );
+  return *DWT_CYCCNT;
+}
+
+#endif //_DWT_H_
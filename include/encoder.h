@@ -6,31 +6,146 @@
 
 #define TICKS_PER_REV 1200
 
-extern volatile uint32_t enc_pos;
-extern volatile uint32_t last_state;
+/** @brief encoders encoder_create can hand out */
+#define ENCODER_MAX   4
+
+/*
+ * Quadrature encoders, any number up to ENCODER_MAX, each made with
+ * encoder_create. Two backends:
+ *
+ * - Where the board's pin map names an ENC_TIMER (gpio_pin_yuhong.h: TIM1
+ *   on PA8/PA9) and the encoder sits on those pins, the timer's encoder
+ *   mode counts every edge in hardware and its update interrupt counts the
+ *   revolutions.
+ * - Otherwise, or with ENCODER=exti, every edge raises the EXTI of its
+ *   pin. All encoders share the EXTI vectors through a table keyed by EXTI
+ *   line, so one interrupt decodes exactly the encoders whose lines are
+ *   pending. An EXTI line is one pin number on any port: two encoders
+ *   cannot use the same pin numbers. Lines 1 to 3 have no vector here.
+ *
+ * Either way the position is a signed 64-bit tick count published under a
+ * sequence counter: reading it never masks interrupts. Only the EXTI
+ * backend of the board's own encoder shows its edges to TRACE=1.
+ *
+ * encoder_init / encoder_read and the rest without an encoder_t work on
+ * the board's own encoder, on the ENC_A / ENC_B pins.
+ */
+
+/** @brief one encoder; owned by encoder.c, read through the functions below */
+typedef struct encoder {
+    /** @brief A and B pins */
+    gpio_port port_a;
+    gpio_port port_b;
+    uint32_t pin_a;
+    uint32_t pin_b;
+    /** @brief ticks per revolution */
+    uint32_t ticks_per_rev;
+    /** @brief timer in encoder mode, 0 on the EXTI backend */
+    int timer;
+    /** @brief EXTI lines it is dispatched on */
+    uint32_t lines;
+    /** @brief AB state at the last edge, (A << 1) | B */
+    volatile uint32_t last_state;
+    /** @brief transitions that skipped a state: an edge was missed */
+    volatile uint32_t illegal;
+    /** @brief odd while the ISR updates what follows */
+    volatile uint32_t seq;
+    /** @brief multi-turn ticks; whole revolutions only on the timer backend */
+    volatile int64_t turns;
+    /** @brief edge log: stamp of the last edge, and of the last two if same way */
+    volatile uint32_t vel_stamp;
+    volatile uint32_t vel_period;
+    volatile int32_t vel_dir;
+    /** @brief encoder_velocity's open M/T window */
+    int64_t win_count;
+    uint32_t win_stamp;
+    uint32_t win_start;
+    uint32_t win_edges;
+    float win_rate;
+    /** @brief count at the last encoder_velocity, timer backend */
+    int64_t polled;
+} encoder_t;
+
+/*
+ * Start decoding the quadrature signal on A and B, forward (B leading A)
+ * counting up. Returns NULL when ENCODER_MAX are in use, or when one of
+ * the EXTI lines is taken or has no vector.
+ */
+encoder_t *encoder_create(gpio_port port_a, uint32_t pin_a, gpio_port port_b, uint32_t pin_b, uint32_t ticks_per_rev);
+
+/*
+ * Stop decoding and give the encoder back; not from an ISR
+ */
+void encoder_delete(encoder_t *enc);
+
+/*
+ * Position, 0 to ticks_per_rev - 1
+ */
+uint32_t encoder_ticks(encoder_t *enc);
+
 /*
- * Initialize the encoder
- * This only supports one encoder at a time
+ * Multi-turn position: signed ticks since encoder_create, forward positive
+ */
+int64_t encoder_turns(encoder_t *enc);
+
+/*
+ * Velocity in ticks per second, forward positive, from the edge timestamps
+ * of ENC_STAMP_TIMER. Keeps its measuring window in enc between calls:
+ * safe from several tasks, but they share the window, so the estimate is
+ * best called from one task every few ms.
+ */
+float encoder_velocity(encoder_t *enc);
+
+/*
+ * Decode the encoders with a pending line in pending (EXTI PR bits) and
+ * clear their lines. Called from the EXTI handlers.
+ */
+void encoder_exti_dispatch(uint32_t pending);
+
+/*
+ * The board's own encoder, NULL before encoder_init
+ */
+encoder_t *encoder_default();
+
+/*
+ * Initialize the board's encoder on ENC_A / ENC_B, TICKS_PER_REV. The
+ * board-encoder calls below read 0 while there is none: before this, after
+ * encoder_stop, or if the pins were taken.
  */
 void encoder_init();
 
 /*
- * Stop the encoder
- * This only supports one encoder at a time
+ * Stop the board's encoder
  */
 void encoder_stop();
 
 /*
- * Handle the IRQ for the encoder
- * Calculate the position.
+ * Decode the board's encoder, as its EXTI would; nothing on the timer backend
  */
 void encoder_irq_handler();
 
 /*
- * Returns the current position of the encoder
+ * Handle the TIM1 update IRQ of the timer backend
+ * Count the revolution CNT wrapped past.
+ */
+void tim1_up_irq_handler();
+
+/*
+ * Returns the current position of the board's encoder, 0 to TICKS_PER_REV - 1
  */
 uint32_t encoder_read();
 
+/*
+ * Returns the board encoder's multi-turn position: signed ticks since
+ * encoder_init, forward positive
+ */
+int64_t encoder_read_position();
+
+/*
+ * Returns the board encoder's velocity, see encoder_velocity
+ */
+float encoder_read_velocity();
+
 /**
 * @brief Register a callback function for the encoder ISR
 *
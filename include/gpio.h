@@ -85,4 +85,9 @@ void gpio_clr(gpio_port port, unsigned int num);
  */
 int gpio_read(gpio_port port, unsigned int num);
 
+/*
+ * gpio_read_port: Read all 16 pins of a port with one IDR load.
+ */
+uint32_t gpio_read_port(gpio_port port);
+
 #endif /* _GPIO_H_ */
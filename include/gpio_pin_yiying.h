@@ -53,6 +53,8 @@
 #define ENC_B_PIN        6
 #define ENC_A_PORT       0  // D13 (PA_5)
 #define ENC_A_PIN        5
+// no ENC_TIMER: PA5 / PA6 are not two channels of one timer, EXTI only
+#define ENC_STAMP_TIMER  5  // 32-bit timer for the edge timestamps; TIM2 is the PWM, servo channel 1 must stay off
 
 // motor
 #define MOTOR_EN_PORT    1  // D3 (PB_3)
@@ -28,6 +28,9 @@
 #define ENC_B_PIN        8
 #define ENC_A_PORT       0  // D8
 #define ENC_A_PIN        9
+#define ENC_TIMER        1  // PA8 / PA9 are TIM1 CH1 / CH2
+#define ENC_TIMER_ALT    0x01 // ALT1
+#define ENC_STAMP_TIMER  2  // free 32-bit timer for the edge timestamps
 #define BUTTON1_PORT     2  // D9
 #define BUTTON1_PIN      7
 #define BUTTON2_PORT     1  // D10
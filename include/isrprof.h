@@ -0,0 +1,60 @@
+#ifndef _ISRPROF_H_
+#define _ISRPROF_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Per-IRQ execution time and entry latency.
+ *
+ * Built with ISR_PROFILE=1, isrprof_init copies the vector table to RAM,
+ * points VTOR at the copy and sends every IRQ through one trampoline that
+ * takes DWT timestamps around the real handler. Per IRQ it keeps the
+ * number of runs, the handler's execution time without the handlers that
+ * preempted it (min/mean/max cycles), the deepest nesting it ran at
+ * (1 = it preempted thread code only) and its entry latency. AT+ISRPROF
+ * prints one line per IRQ that ran,
+ *
+ *     isr,<irq>,<name>,<runs>,<min>,<mean>,<max>,<depth>,<lat_min>,<lat_mean>,<lat_max>
+ *
+ * and AT+ISRPROF=CLEAR starts over. Latency is from the pending edge to
+ * the handler, in cycles; only the timer update IRQs (TIM2..TIM5) date
+ * their edge, from CNT since the update, so the others print "-". The
+ * trampoline's own cycles are not in the handler's time; when nested they
+ * land in the preempted handler's. With PC_PROFILE=1 the TIM4 sampler
+ * keeps its own vector and is not listed: it reads the exception frame.
+ *
+ * Without ISR_PROFILE the calls compile to nothing.
+ */
+
+/** @brief IRQs routed through the trampoline, as many as asm/boot.S lists */
+#define ISRPROF_IRQS    (68)
+/** @brief nesting levels tracked; deeper ones are counted at the last */
+#define ISRPROF_DEPTH   (8)
+
+#ifdef ISR_PROFILE
+
+/*
+ * Move the vector table to RAM behind the trampoline and clear the
+ * statistics. Call once, before the handlers matter.
+ */
+void isrprof_init(void);
+
+/*
+ * Clear the statistics
+ */
+void isrprof_clear(void);
+
+/*
+ * Print the statistics on the console, in the format above
+ */
+void isrprof_dump(void);
+
+#else
+
+#define isrprof_init()  ((void)0)
+#define isrprof_clear() ((void)0)
+#define isrprof_dump()  ((void)0)
+
+#endif /* ISR_PROFILE */
+
+#endif /* _ISRPROF_H_ */
@@ -7,5 +7,7 @@ void lcd_driver_init();
 void lcd_print(char *input);
 void lcd_set_cursor(uint8_t row, uint8_t col);
 void lcd_clear();
+void lcd_send_instruction(uint8_t command);
+void lcd_send_data(uint8_t data);
 
 #endif /* _LCD_DRIVER_H_ */
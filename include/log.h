@@ -0,0 +1,81 @@
+#ifndef _LOG_H_
+#define _LOG_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Deferred-formatting logger.
+ *
+ * LOG("fmt", args...) stores the format string in the .logstr section,
+ * which the linker script marks (INFO) so it is kept in the ELF but never
+ * loaded. Only the string's address, a timestamp and the raw 32-bit
+ * arguments are queued; a task woken per record ships them as telemetry frames
+ * (TELEMETRY_FRAME_LOG) and python/logdecode.py rebuilds the text from the
+ * ELF. Safe from any task, and from interrupts at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY (it wakes the drain task through
+ * the kernel); records are dropped when full.
+ *
+ * Arguments are integers (up to 32 bits), float/double (sent as float
+ * bits, printed with %f/%e/%g), or pointers to strings that live in the
+ * image (%s, resolved on the host from .rodata). At most LOG_MAX_ARGS.
+ */
+
+/** @brief most arguments one LOG call can carry */
+#define LOG_MAX_ARGS    (6)
+
+/** @brief log ring size in bytes, a power of two */
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE (1024)
+#endif
+
+/*
+ * Set up the log ring and start the drain task
+ */
+void log_init(void);
+
+/*
+ * Queue one record. fmt must point into .logstr; use LOG() instead.
+ */
+void log_record(const char *fmt, const uint32_t *args, uint32_t nargs);
+
+/*
+ * Records dropped because the log ring was full
+ */
+uint32_t log_dropped(void);
+
+/** @brief argument conversion helpers, picked by LOG_ARG */
+static inline uint32_t log_arg_word(uint32_t x) { return x; }
+static inline uint32_t log_arg_float(float x) { union { float f; uint32_t u; } v = { .f = x }; return v.u; }
+static inline uint32_t log_arg_ptr(const void *x) { return (uint32_t)(uintptr_t)x; }
+
+/** @brief raw 32-bit image of one argument */
+#define LOG_ARG(x) _Generic((x),        \
+    float: log_arg_float,               \
+    double: log_arg_float,              \
+    char *: log_arg_ptr,                \
+    const char *: log_arg_ptr,          \
+    default: log_arg_word)(x)
+
+/** @brief argument count, 0 to LOG_MAX_ARGS */
+#define LOG_NARGS(...) LOG_NARGS_(, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+
+/** @brief LOG_ARG applied to each argument, each preceded by a comma */
+#define LOG_MAP_0()
+#define LOG_MAP_1(a)                    , LOG_ARG(a)
+#define LOG_MAP_2(a, b)                 LOG_MAP_1(a) LOG_MAP_1(b)
+#define LOG_MAP_3(a, b, c)              LOG_MAP_2(a, b) LOG_MAP_1(c)
+#define LOG_MAP_4(a, b, c, d)           LOG_MAP_3(a, b, c) LOG_MAP_1(d)
+#define LOG_MAP_5(a, b, c, d, e)        LOG_MAP_4(a, b, c, d) LOG_MAP_1(e)
+#define LOG_MAP_6(a, b, c, d, e, f)     LOG_MAP_5(a, b, c, d, e) LOG_MAP_1(f)
+#define LOG_CAT(a, b)   LOG_CAT_(a, b)
+#define LOG_CAT_(a, b)  a##b
+
+/** @brief log a printf-style message, formatted on the host */
+#define LOG(fmt, ...) do {                                                          \
+    static const char log_fmt_[] __attribute__((section(".logstr"), used)) = fmt;   \
+    const uint32_t log_args_[] = { 0 LOG_CAT(LOG_MAP_, LOG_NARGS(__VA_ARGS__))(__VA_ARGS__) }; \
+    log_record(log_fmt_, &log_args_[1], LOG_NARGS(__VA_ARGS__));                    \
+} while (0)
+
+#endif /* _LOG_H_ */
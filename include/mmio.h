@@ -0,0 +1,38 @@
+/**
+ * @file   mmio.h
+ *
+ * @brief  Side-effect markers for peripheral registers
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+#ifndef _MMIO_H_
+#define _MMIO_H_
+
+/*
+ * Some registers do more than hold a value: writing 1 clears a flag
+ * (DMA xIFCR, NVIC ICER/ICPR), a write starts something (DMA EN), or a
+ * read clears status (USART SR then DR). A driver marks such an access
+ * right after it with MMIO_WRITTEN(reg) / MMIO_READ(reg).
+ *
+ * On the board these expand to nothing. In the host build (make host) the
+ * registers are plain memory, and the markers tell the simulated
+ * peripheral behind reg what just happened (see sim/).
+ */
+#ifdef HOST_SIM
+
+void sim_reg_written( volatile void *reg );
+void sim_reg_read( volatile void *reg );
+
+#define MMIO_WRITTEN( reg ) sim_reg_written( &( reg ) )
+#define MMIO_READ( reg )    sim_reg_read( &( reg ) )
+
+#else
+
+#define MMIO_WRITTEN( reg ) ( ( void )0 )
+#define MMIO_READ( reg )    ( ( void )0 )
+
+#endif /* HOST_SIM */
+
+#endif /* _MMIO_H_ */
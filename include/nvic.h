@@ -9,6 +9,7 @@
 #ifndef _NVIC_H_
 #define _NVIC_H_
 
+#include <stdint.h>
 #include <unistd.h>
 
 struct nvic_t {
@@ -17,12 +18,17 @@ struct nvic_t {
 
 #define NVIC_ISER_BASE (struct nvic_t *) 0xE000E100
 #define NVIC_ICER_BASE (struct nvic_t *) 0xE000E180
+#define NVIC_ISPR_BASE (struct nvic_t *) 0xE000E200
 #define NVIC_ICPR_BASE (struct nvic_t *) 0xE000E280
+#define NVIC_IPR_BASE (volatile uint8_t *) 0xE000E400
+#define NVIC_PRIO_SHIFT 4
 #define NVIC_REG_SIZE 32
 #define IRQ_ENABLE 1
 #define IRQ_DISABLE 0
 
 void nvic_irq( uint8_t irq_num, uint8_t status );
 void nvic_clear_pending( uint8_t irq_num );
+void nvic_set_pending( uint8_t irq_num );
+void nvic_set_priority( uint8_t irq_num, uint8_t priority );
 
 #endif //_NVIC_H
@@ -0,0 +1,66 @@
+#ifndef _PCPROF_H_
+#define _PCPROF_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Statistical PC-sampling profiler.
+ *
+ * Built with PC_PROFILE=1, pcprof_init runs TIM4 at about PCPROF_HZ. Its
+ * handler reads the PC the interrupted code stacked in its exception frame
+ * and counts it in a RAM histogram of the .text section, and counts the
+ * sample against the running task, or against "isr" when it preempted
+ * another handler. TIM4 keeps NVIC priority 0, above
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY, so kernel critical sections and the
+ * other handlers get sampled too. AT+PCPROF prints
+ *
+ *     pcprof,hz,<hz>,samples,<n>,base,<hex>,shift,<bits>
+ *     pcprof,task,<name>,<count>        one per task seen, and "isr"
+ *     pcprof,pc,<hex>,<count>           one per non-empty bucket
+ *     pcprof,end
+ *
+ * where bucket i covers [base + (i << shift), base + ((i + 1) << shift)).
+ * Samples outside .text (RAM, ROM bootloader) are counted as "pc,0".
+ * AT+PCPROF=CLEAR starts over. python/pcprof.py symbolizes the dump
+ * against the ELF.
+ *
+ * Without PC_PROFILE the calls compile to nothing.
+ */
+
+/** @brief sampling rate; 1 MHz / 487 us, prime so it cannot lock onto the
+ *         millisecond periods of the tasks */
+#define PCPROF_PERIOD_US    (487)
+#define PCPROF_HZ           (1000000 / PCPROF_PERIOD_US)
+/** @brief histogram buckets; the bucket size is the smallest power of two
+ *         that spreads .text over them */
+#define PCPROF_BUCKETS      (2048)
+/** @brief tasks told apart; samples in later ones are not counted per task */
+#define PCPROF_TASKS        (16)
+
+#ifdef PC_PROFILE
+
+/*
+ * Clear the histogram and start sampling. Call once, before the scheduler
+ * starts.
+ */
+void pcprof_init(void);
+
+/*
+ * Clear the histogram
+ */
+void pcprof_clear(void);
+
+/*
+ * Print the histogram on the console, in the format above
+ */
+void pcprof_dump(void);
+
+#else
+
+#define pcprof_init()  ((void)0)
+#define pcprof_clear() ((void)0)
+#define pcprof_dump()  ((void)0)
+
+#endif /* PC_PROFILE */
+
+#endif /* _PCPROF_H_ */
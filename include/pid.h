@@ -0,0 +1,49 @@
+#ifndef _PID_H_
+#define _PID_H_
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include "semphr.h"
+
+/** @brief define highest motor speed */
+#define MAX_MOTOR_SPEED 90
+/** @brief define lowest motor speed */
+#define MIN_MOTOR_SPEED 10
+
+/** @brief PID parameters */
+typedef struct {
+    /** @brief PID parameters */
+    float P;
+    /** @brief PID parameters */
+    float I;
+    /** @brief PID parameters */
+    float D;
+    /** @brief PID parameters */
+    float integrator;
+    /** @brief PID parameters */
+    float prevError;
+    /** @brief PID parameters */
+    SemaphoreHandle_t mutex;
+} PIDParameters;
+
+/*
+ * One PID step on error, deltaTime in seconds since the last one.
+ * Takes pid->mutex around the state update.
+ */
+float UpdatePID(PIDParameters *pid, int error, float deltaTime);
+
+/*
+ * Signed ticks from current_pos to target_pos the short way round
+ * the encoder's TICKS_PER_REV
+ */
+int32_t findBestPath(uint32_t current_pos, uint32_t target_pos);
+
+/*
+ * One iteration of the position loop: the short-way error from curr_pos
+ * to target_pos (stored in *error), a PID step over deltaTime, and its
+ * output as a signed duty cycle of MIN_MOTOR_SPEED to MAX_MOTOR_SPEED
+ * percent. Positive drives FORWARD, which counts the encoder up.
+ */
+int32_t pid_control_step(PIDParameters *pid, uint32_t curr_pos, uint32_t target_pos, float deltaTime, int32_t *error);
+
+#endif /* _PID_H_ */
@@ -0,0 +1,102 @@
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Single-producer / single-consumer byte ring.
+ *
+ * head and tail are free-running 16-bit counters, masked only when they
+ * index the storage, so all `size` bytes are usable and used = tail - head.
+ * size must be a power of two no larger than 32768.
+ */
+typedef struct {
+    /** @brief backing storage, owned by the caller */
+    uint8_t *buffer;
+    /** @brief capacity in bytes (power of two) */
+    uint16_t size;
+    /** @brief size - 1 */
+    uint16_t mask;
+    /** @brief read counter, only advanced by the consumer */
+    volatile uint16_t head;
+    /** @brief write counter, only advanced by the producer */
+    volatile uint16_t tail;
+} RingBuffer;
+
+/*
+ * Attach storage to a ring and mark it empty.
+ * Returns -1 if size is not a power of two.
+ */
+int RingBuffer_init(RingBuffer *rb, uint8_t *storage, uint16_t size);
+
+int RingBuffer_isEmpty(RingBuffer *rb);
+int RingBuffer_isFull(RingBuffer *rb);
+uint16_t RingBuffer_used(RingBuffer *rb);
+uint16_t RingBuffer_free(RingBuffer *rb);
+
+/*
+ * Single byte access, 0 on success and -1 if full / empty
+ */
+int RingBuffer_Write(RingBuffer *rb, char data);
+int RingBuffer_Read(RingBuffer *rb, char *data);
+
+/*
+ * Copy up to len bytes in or out with at most two memcpys.
+ * Return the number of bytes actually copied.
+ */
+uint16_t RingBuffer_WriteBlock(RingBuffer *rb, const void *data, uint16_t len);
+uint16_t RingBuffer_ReadBlock(RingBuffer *rb, void *data, uint16_t len);
+
+/*
+ * Zero-copy access: Peek returns the length of the contiguous free (Write)
+ * or filled (Read) span and points *span at it. Commit publishes len bytes
+ * of that span. A span never crosses the end of the storage, so a second
+ * peek after the commit returns the wrapped part.
+ */
+uint16_t RingBuffer_PeekWrite(RingBuffer *rb, uint8_t **span);
+void RingBuffer_CommitWrite(RingBuffer *rb, uint16_t len);
+uint16_t RingBuffer_PeekRead(RingBuffer *rb, uint8_t **span);
+void RingBuffer_CommitRead(RingBuffer *rb, uint16_t len);
+
+/**
+ * @brief Multi-producer / single-consumer byte ring.
+ *
+ * Producers claim space with LDREX/STREX on `claim`, which packs the
+ * reserve counter (low 16 bits) with the number of producers still
+ * copying (high 16 bits), so claiming and joining the writer set is one
+ * atomic step. The last producer to finish publishes everything reserved
+ * so far by moving rb.tail, which is all the consumer ever looks at. No
+ * producer waits on another, so tasks and ISRs can share one queue.
+ */
+typedef struct {
+    /** @brief consumer view: head is the read counter, tail the published counter */
+    RingBuffer rb;
+    /** @brief reserve counter | (writers in progress << 16) */
+    volatile uint32_t claim;
+} MpscRingBuffer;
+
+int MpscRingBuffer_init(MpscRingBuffer *q, uint8_t *storage, uint16_t size);
+
+/*
+ * Bytes a producer could still reserve right now
+ */
+uint16_t MpscRingBuffer_free(MpscRingBuffer *q);
+
+/*
+ * Claim len contiguous-in-sequence bytes, all or nothing.
+ * Returns 0 and the start counter in *start, or -1 if there is no room.
+ * Every successful reserve must be followed by exactly one publish.
+ */
+int MpscRingBuffer_Reserve(MpscRingBuffer *q, uint16_t len, uint16_t *start);
+
+/*
+ * Copy into a reserved region starting at counter start (handles the wrap)
+ */
+void MpscRingBuffer_Fill(MpscRingBuffer *q, uint16_t start, const void *data, uint16_t len);
+
+/*
+ * Leave the writer set; the last writer out makes all reserved bytes visible
+ */
+void MpscRingBuffer_Publish(MpscRingBuffer *q);
+
+#endif /* _RING_BUFFER_H_ */
@@ -0,0 +1,32 @@
+/**
+ * @file   semihosting.h
+ *
+ * @brief  ARM semihosting console, for runs under QEMU or a debugger
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+#ifndef _SEMIHOSTING_H_
+#define _SEMIHOSTING_H_
+
+/*
+ * Built with -DSEMIHOSTING (make qemu) the console goes through the
+ * semihosting host instead of USART2: uart.c hands every queued span to
+ * semihosting_write, and _exit ends the run with the program's status.
+ * Without a semihosting host attached, "bkpt 0xAB" is a HardFault, so such
+ * an image is not for a board on its own.
+ */
+
+/*
+ * Write len bytes to the host's console. Returns 0, or -1 if the host
+ * refused them.
+ */
+int semihosting_write( const char *buf, int len );
+
+/*
+ * End the run and hand status to the host (QEMU exits with it)
+ */
+void semihosting_exit( int status ) __attribute__( ( noreturn ) );
+
+#endif /* _SEMIHOSTING_H_ */
@@ -0,0 +1,72 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Binary frames on the console link.
+ *
+ * A frame is [type][payload][crc16 lo][crc16 hi], COBS encoded and followed
+ * by a single 0x00. Text printed with printf never contains 0x00, so the
+ * host can split the stream on zeros and keep text and frames apart.
+ * Multi-byte fields are little endian.
+ */
+
+/** @brief frame type of telemetry_sample_t */
+#define TELEMETRY_FRAME_SAMPLE  (0x01)
+/** @brief frame type of a deferred log record: fmt id, timestamp, args */
+#define TELEMETRY_FRAME_LOG     (0x02)
+
+/** @brief longest payload telemetry_send accepts */
+#define TELEMETRY_MAX_PAYLOAD   (64)
+
+/** @brief one control loop iteration */
+typedef struct {
+    /** @brief ms since the scheduler started */
+    uint32_t timestamp;
+    /** @brief encoder position in ticks */
+    int32_t position;
+    /** @brief target position in ticks */
+    int32_t target;
+    /** @brief signed shortest-path error in ticks */
+    int32_t error;
+    /** @brief signed duty cycle, negative when driving backward */
+    int16_t pwm;
+} telemetry_sample_t;
+
+/*
+ * CRC-16/CCITT-FALSE (poly 0x1021), pass 0xFFFF as crc to start
+ */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len);
+
+/*
+ * COBS encode len bytes of src into dst, which must hold len + len / 254 + 1
+ * bytes. Returns the encoded length, the 0x00 delimiter is not added.
+ */
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst);
+
+/*
+ * Frame and queue a payload without blocking.
+ * Returns 0, or -1 if the payload is too long or the UART queue is full
+ * (the frame is dropped and counted).
+ */
+int telemetry_send(uint8_t type, const void *payload, size_t len);
+
+/*
+ * Frame and queue a payload, blocking (bounded by the UART TX timeout)
+ * until there is room for it. For background senders such as the logger.
+ */
+int telemetry_send_wait(uint8_t type, const void *payload, size_t len);
+
+/*
+ * Send one control loop sample
+ */
+int telemetry_send_sample(const telemetry_sample_t *sample);
+
+/*
+ * Number of frames dropped because the UART queue was full
+ */
+uint32_t telemetry_dropped(void);
+
+#endif /* _TELEMETRY_H_ */
@@ -5,6 +5,8 @@
 #include <gpio.h>
 
 #define TIM_SR_UIF (1)
+#define TIM_DIER_UIE (1)
+#define TIM1_UP_INT_NUM 25
 #define TIM2_INT_NUM    28
 #define TIM3_INT_NUM    29
 #define TIM4_INT_NUM    30
@@ -35,6 +37,10 @@ extern struct tim2_5* const timer_base[];
 
 void timer_start_pwm(int timer, uint32_t channel, uint32_t prescalar, uint32_t period, uint32_t duty_cycle);
 
+void timer_start_encoder(int timer, uint32_t period);
+
+void timer_start_counter(int timer, uint32_t prescalar);
+
 void timer_set_duty_cycle(int timer, uint32_t channel, uint32_t duty_cycle);
 
 void timer_init(int timer, uint32_t prescalar, uint32_t period);
@@ -0,0 +1,72 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <ring_buffer.h>
+
+/**
+ * @brief Input recorder for latency regressions.
+ *
+ * Built with TRACE=1, every external input the firmware takes in goes into
+ * a RAM trace with its DWT timestamp: encoder states, button edges, keys
+ * from the keypad and bytes off the UART. AT+TRACE prints it as
+ *
+ *     trace,<us since trace_init>,<enc|button|key|uart>,<data>
+ *     trace,end,<events>,<dropped>
+ *
+ * and SIM_REPLAY=<file> plays such a dump into the host build at the same
+ * times (sim/sim_replay.c). Recording stops when the trace is full, so a
+ * dump is always a replayable prefix of the run. Timestamps wrap after
+ * 2^32 cycles, about 268 s at 16 MHz. trace_init restarts the DWT cycle
+ * counter, so other users of it (AT+FMTBENCH) must not span a restart.
+ *
+ * Without TRACE the calls compile to nothing.
+ */
+
+/** @brief events the trace holds */
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS    (512)
+#endif
+
+/** @brief what an event is; data is given with each */
+typedef enum {
+    TRACE_ENCODER = 1,  /**< AB state the encoder ISR read */
+    TRACE_BUTTON,       /**< EXTI line of a button edge */
+    TRACE_KEY,          /**< key keypad_read returned */
+    TRACE_UART,         /**< byte the RX DMA handed over */
+} trace_event_t;
+
+#ifdef TRACE
+
+/*
+ * Start the cycle counter and empty the trace; time 0 is now
+ */
+void trace_init(void);
+
+/*
+ * Record one event. Safe from any task or interrupt, never blocks.
+ */
+void trace_record(trace_event_t event, uint8_t data);
+
+/*
+ * Record len bytes of rb, starting at counter value from, as events with
+ * one timestamp: they came in together
+ */
+void trace_record_ring(trace_event_t event, const RingBuffer *rb, uint16_t from, uint16_t len);
+
+/*
+ * Print the trace on the console, in the format above
+ */
+void trace_dump(void);
+
+#else
+
+#define trace_init()                ((void)0)
+#define trace_record(event, data)   ((void)(event), (void)(data))
+#define trace_record_ring(event, rb, from, len) \
+    ((void)(event), (void)(rb), (void)(from), (void)(len))
+#define trace_dump()                ((void)0)
+
+#endif /* TRACE */
+
+#endif /* _TRACE_H_ */
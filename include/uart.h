@@ -11,20 +11,48 @@
 #ifndef _UART_H_
 #define _UART_H_
 
+#include <stdint.h>
+
 /** @brief  Built-in file descriptors */
 //@{
 #define FD_STDIN 0
 #define FD_STDOUT 1
 //@}
 
+/** @brief Link health counters, all since uart_init */
+typedef struct {
+    /** @brief USART overrun errors (ORE), a byte was lost in hardware */
+    uint32_t overrun;
+    /** @brief framing errors (FE), usually a baud rate mismatch */
+    uint32_t framing;
+    /** @brief noise detected while sampling (NF) */
+    uint32_t noise;
+    /** @brief received bytes overwritten before uart_read got to them */
+    uint32_t rx_dropped;
+    /** @brief times RTS was raised to pause the host */
+    uint32_t rx_throttled;
+    /** @brief highest RX ring occupancy seen, in bytes */
+    uint16_t rx_peak;
+    /** @brief bytes uart_write / uart_put_byte could not queue */
+    uint32_t tx_dropped;
+} uart_stats_t;
+
 void uart_init(int baud);
 
+void uart_get_stats(uart_stats_t *stats);
+
+int uart_check_baud(int baud);
+
+int uart_set_baud(int baud);
+
 int uart_put_byte(char c);
 
 int uart_get_byte(char *c);
 
 int uart_write( int file, char *ptr, int len );
 
+int uart_write_nonblock( const char *ptr, int len );
+
 int uart_read(int file, char *ptr, int len );
 
 #endif /* _UART_H_ */
@@ -0,0 +1,262 @@
+/**
+ * @file main.c
+ *
+ * @brief PROJ=bench: DWT cycle counts of the driver hot paths
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include "semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <uart.h>
+#include <gpio.h>
+#include <i2c.h>
+#include <lcd_driver.h>
+#include <encoder.h>
+#include <ring_buffer.h>
+#include <atcmd.h>
+#include <pid.h>
+#include <dwt.h>
+
+/** @brief define gpio pin header file */
+#define YUHONG
+#ifdef YUHONG
+#include "gpio_pin_yuhong.h"
+#elif defined YIYING
+#include "gpio_pin_yiying.h"
+#endif
+
+/*
+ * Every case runs BENCH_RUNS times (fewer for the ones that wait on a bus)
+ * and prints one CSV line on the console:
+ *
+ *     bench,<function>,<warm|cold>,<runs>,<min>,<mean>,<max>
+ *
+ * in CPU cycles, with the harness's own cost (the "overhead" line, an
+ * empty call) taken off. Warm runs back to back after one untimed call.
+ * Cold runs flush the flash accelerator's caches first, and on the host
+ * also sweep the CPU caches. At 16 MHz the flash has no wait states and
+ * the ART caches are off, so on the board warm and cold only part once
+ * the clock goes up; interrupts stay on, so max includes preemption.
+ * encoder_irq_handler is only timed on the EXTI backend (ENCODER=exti
+ * with the YUHONG pins). The run ends with "bench,done" and exit(0),
+ * which stops make qemu and make host.
+ */
+
+/** @brief timed calls per case */
+#define BENCH_RUNS          (100)
+/** @brief timed calls for the cases that wait on I2C */
+#define BENCH_RUNS_BUS      (20)
+/** @brief stack of the benchmark task */
+#define BENCH_STACK_WORDS   (configMINIMAL_STACK_SIZE * 2)
+
+/** @brief FLASH_ACR and its cache bits */
+#define FLASH_ACR           (volatile uint32_t *) 0x40023C00
+#define FLASH_ACR_ICEN      (1 << 9)
+#define FLASH_ACR_DCEN      (1 << 10)
+#define FLASH_ACR_ICRST     (1 << 11)
+#define FLASH_ACR_DCRST     (1 << 12)
+
+#ifdef HOST_SIM
+/** @brief swept before a cold run, larger than the host's last level cache */
+#define BENCH_SWEEP_BYTES   (8 * 1024 * 1024)
+static volatile uint8_t bench_sweep[BENCH_SWEEP_BYTES];
+#endif
+
+/** @brief one function under test */
+typedef struct {
+    /** @brief name in the report */
+    const char *name;
+    /** @brief puts the state back before each call, untimed; may be NULL */
+    void (*setup)(void);
+    /** @brief the call that is timed */
+    void (*run)(void);
+    /** @brief timed calls per case */
+    uint32_t runs;
+} bench_t;
+
+/** @brief what the harness itself costs, taken off every sample */
+static uint32_t bench_overhead;
+
+/** @brief results go here so the calls are not optimized away */
+static volatile float bench_sink;
+
+/** @brief state of the functions under test */
+static PIDParameters bench_pid = {2.81f, 0.38f, 0.09f, 0.0f, 0.0f, NULL};
+static uint8_t bench_ring_storage[64];
+static RingBuffer bench_ring;
+static atcmd_parser_t bench_parser;
+static char bench_cmd[] = "AT+NOP=1";
+
+/**
+ * @brief  the command atcmd_parse finds
+ *
+*/
+static uint8_t bench_atcmd_nop(void *args, const char *cmdargs) {
+    (void)args;
+    (void)cmdargs;
+    return 1;
+}
+
+/** @brief commands known to the parser under test; NOP sits last */
+static const atcmd_t bench_atcmds[] = {
+    {"BAUD", bench_atcmd_nop, NULL},
+    {"FMTBENCH", bench_atcmd_nop, NULL},
+    {"STATS", bench_atcmd_nop, NULL},
+    {"NOP", bench_atcmd_nop, NULL},
+};
+
+static void bench_nop(void) {
+}
+
+/**
+ * @brief  last_state one Gray step away from the pins, so the handler
+ *         always counts
+ *
+*/
+static void bench_encoder_setup(void) {
+    uint32_t state = (gpio_read(ENC_A_PORT, ENC_A_PIN) << 1) | gpio_read(ENC_B_PORT, ENC_B_PIN);
+    encoder_default()->last_state = state ^ 1;
+}
+
+static void bench_encoder_run(void) {
+    encoder_irq_handler();
+}
+
+static void bench_pid_run(void) {
+    bench_sink = UpdatePID(&bench_pid, 37, 0.01f);
+}
+
+static void bench_ring_setup(void) {
+    RingBuffer_init(&bench_ring, bench_ring_storage, sizeof(bench_ring_storage));
+}
+
+static void bench_ring_run(void) {
+    RingBuffer_Write(&bench_ring, 'x');
+}
+
+static void bench_lcd_run(void) {
+    lcd_send_data(' ');
+}
+
+static void bench_atcmd_run(void) {
+    bench_sink = atcmd_parse(&bench_parser, bench_cmd);
+}
+
+/** @brief the hot paths, in report order */
+static const bench_t benches[] = {
+    {"encoder_irq_handler", bench_encoder_setup, bench_encoder_run, BENCH_RUNS},
+    {"UpdatePID", NULL, bench_pid_run, BENCH_RUNS},
+    {"RingBuffer_Write", bench_ring_setup, bench_ring_run, BENCH_RUNS},
+    {"lcd_send_data", NULL, bench_lcd_run, BENCH_RUNS_BUS},
+    {"atcmd_parse", NULL, bench_atcmd_run, BENCH_RUNS},
+};
+
+/**
+ * @brief  empty the flash accelerator's caches (they only reset while
+ *         disabled) and, on the host, the CPU caches
+ *
+*/
+static void bench_flush_caches(void) {
+    uint32_t acr = *FLASH_ACR;
+    *FLASH_ACR = acr & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+    *FLASH_ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    *FLASH_ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+    *FLASH_ACR = acr;
+#ifdef HOST_SIM
+    for (uint32_t i = 0; i < BENCH_SWEEP_BYTES; i += 64) {
+        bench_sweep[i]++;
+    }
+#endif
+}
+
+/**
+ * @brief  time bench->runs calls and print their line; the minimum sample
+ *         is returned for the overhead measurement
+ *
+*/
+static uint32_t bench_case(const bench_t *bench, int cold) {
+    uint32_t min = UINT32_MAX, max = 0;
+    uint64_t sum = 0;
+
+    if (!cold) {
+        if (bench->setup != NULL) {
+            bench->setup();
+        }
+        bench->run();
+    }
+    for (uint32_t i = 0; i < bench->runs; i++) {
+        if (bench->setup != NULL) {
+            bench->setup();
+        }
+        if (cold) {
+            bench_flush_caches();
+        }
+        uint32_t start = dwt_cycles();
+        bench->run();
+        uint32_t cycles = dwt_cycles() - start;
+        cycles = (cycles > bench_overhead) ? cycles - bench_overhead : 0;
+        min = (cycles < min) ? cycles : min;
+        max = (cycles > max) ? cycles : max;
+        sum += cycles;
+    }
+    printf("bench,%s,%s,%lu,%lu,%lu,%lu\n", bench->name, cold ? "cold" : "warm", (unsigned long)bench->runs,
+           (unsigned long)min, (unsigned long)(sum / bench->runs), (unsigned long)max);
+    return min;
+}
+
+/**
+ * @brief  measure the harness, then every hot path warm and cold
+ *
+*/
+static void vBenchTask(void *pvParameters) {
+    (void)pvParameters;
+    const bench_t overhead = {"overhead", NULL, bench_nop, BENCH_RUNS};
+
+    dwt_init();
+    printf("bench,function,case,runs,min,mean,max\n");
+    bench_overhead = bench_case(&overhead, 0);
+    for (uint32_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (benches[i].run == bench_encoder_run && (encoder_default() == NULL || encoder_default()->timer != 0)) {
+            // TIM1 counts the edges, there is no handler per edge to time
+            continue;
+        }
+        bench_case(&benches[i], 0);
+        bench_case(&benches[i], 1);
+    }
+    printf("bench,done\n");
+    // let the console drain before the run ends
+    vTaskDelay(pdMS_TO_TICKS(100));
+    exit(0);
+}
+
+/**
+ * @brief main funtion
+ *
+*/
+int main( void ) {
+    uart_init(115200);
+    i2c_master_init(80);
+    encoder_init();
+    bench_pid.mutex = xSemaphoreCreateMutex();
+    atcmd_parser_init(&bench_parser, bench_atcmds, sizeof(bench_atcmds) / sizeof(bench_atcmds[0]));
+
+    xTaskCreate(
+        vBenchTask,
+        "Bench",
+        BENCH_STACK_WORDS,
+        NULL,
+        tskIDLE_PRIORITY + 2,
+        NULL);
+
+    vTaskStartScheduler();
+
+    // Infinite loop
+    for(;;) {}
+    return 0;
+}
@@ -0,0 +1,352 @@
+/**
+ * @file main.c
+ *
+ * @brief PROJ=ctrlbench: motion scenarios for the position loop, with
+ *        step-response metrics and a pass/fail verdict
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include "semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <uart.h>
+#include <gpio.h>
+#include <encoder.h>
+#include <motor_driver.h>
+#include <pid.h>
+#include <dwt.h>
+
+/** @brief define gpio pin header file */
+#define YUHONG
+#ifdef YUHONG
+#include "gpio_pin_yuhong.h"
+#elif defined YIYING
+#include "gpio_pin_yiying.h"
+#endif
+
+/*
+ * The loop under test is motorControlTask's: encoder_read, pid_control_step
+ * and motor_set_dir every 10 ms. Every gain set runs every scenario; each
+ * scenario first holds its start target for CTRL_HOLD_MS (untimed), then
+ * runs for its window and prints one CSV line on the console:
+ *
+ *     ctrl,<gains>,<scenario>,<rise_ms>,<overshoot>,<settle_ms>,<sse>,
+ *          <peak_pwm>,<min>,<mean>,<max>,<PASS|FAIL>
+ *
+ * Positions are in encoder ticks, unwrapped across 0, and measured against
+ * the last target of the scenario:
+ *
+ *   rise_ms    10 % to 90 % of the move; - for a scenario without a move
+ *   overshoot  furthest past the target in the direction of the move; for
+ *              a scenario without a move, furthest off it either way
+ *   settle_ms  from the start (the end of the shove for "disturbance") to
+ *              the last sample outside +-CTRL_BAND; -1 if still outside
+ *   sse        mean |error| over the last CTRL_SSE_MS of the window
+ *   peak_pwm   largest |duty| the loop asked for, percent
+ *   min..max   CPU cycles of one loop iteration
+ *
+ * A scenario passes when every metric is within its limits. The run ends
+ * with "ctrl,done,<passed>,<runs>" and exits 1 if the first gain set (the
+ * shipped one) failed any, which stops make qemu and make host; the other
+ * sets are there to compare against. On the board the same image runs the
+ * real motor, so a run there and one in the host build line up column for
+ * column.
+ */
+
+/** @brief loop period, as motorControlTask */
+#define CTRL_PERIOD_MS      (10)
+/** @brief start target held before a scenario */
+#define CTRL_HOLD_MS        (1500)
+/** @brief band around the target that counts as settled, ticks */
+#define CTRL_BAND           (12)
+/** @brief tail of the window steady-state error is averaged over */
+#define CTRL_SSE_MS         (500)
+/** @brief the shove of "disturbance": when, for how long */
+#define CTRL_SHOVE_AT_MS    (200)
+#define CTRL_SHOVE_MS       (100)
+/** @brief target changes per scenario, at most */
+#define CTRL_MOVES          (4)
+/** @brief one button press */
+#define CTRL_BUTTON         (200)
+/** @brief stack of the benchmark task */
+#define CTRL_STACK_WORDS    (configMINIMAL_STACK_SIZE * 2)
+
+/** @brief milliseconds to CPU cycles */
+#define CTRL_MS_CYCLES(ms)  ((uint32_t)(ms) * (configCPU_CLOCK_HZ / 1000))
+
+/** @brief one gain set */
+typedef struct {
+    /** @brief name in the report */
+    const char *name;
+    float P;
+    float I;
+    float D;
+} ctrl_gains_t;
+
+/** @brief one motion scenario */
+typedef struct {
+    /** @brief name in the report */
+    const char *name;
+    /** @brief target held before the start; -1 keeps the current one */
+    int32_t start;
+    /** @brief target changes, CTRL_MOVES at most, every interval_ms */
+    int32_t moves[CTRL_MOVES];
+    uint32_t num_moves;
+    uint32_t interval_ms;
+    /** @brief shove the shaft away from the target mid-window */
+    int shove;
+    /** @brief length of the window */
+    uint32_t window_ms;
+    /** @brief limits: rise and settle in ms, overshoot and sse in ticks */
+    uint32_t max_rise_ms;
+    uint32_t max_overshoot;
+    uint32_t max_settle_ms;
+    uint32_t max_sse;
+} ctrl_scenario_t;
+
+/** @brief what one run measured */
+typedef struct {
+    int32_t rise_ms;
+    int32_t overshoot;
+    int32_t settle_ms;
+    int32_t sse;
+    int32_t peak_pwm;
+    uint32_t cycles_min;
+    uint32_t cycles_mean;
+    uint32_t cycles_max;
+} ctrl_result_t;
+
+/** @brief the shipped gains (src/main.c) first; candidates after them */
+static const ctrl_gains_t gain_sets[] = {
+    {"shipped", 2.81f, 0.38f, 0.09f},
+    {"p-only", 2.81f, 0.0f, 0.0f},
+};
+
+/** @brief the suite, in report order */
+static const ctrl_scenario_t scenarios[] = {
+    {"step-up", 50, {CTRL_BUTTON}, 1, 0, 0, 2000, 400, 40, 1500, 12},
+    {"step-down", -1, {-CTRL_BUTTON}, 1, 0, 0, 2000, 400, 40, 1500, 12},
+    // across 0 the short way, as findBestPath must find it
+    {"wrap-up", 1100, {CTRL_BUTTON}, 1, 0, 0, 2000, 400, 40, 1500, 12},
+    {"wrap-down", 100, {-CTRL_BUTTON}, 1, 0, 0, 2000, 400, 40, 1500, 12},
+    {"disturbance", -1, {0}, 0, 0, 1, 2000, 0, 400, 1000, 12},
+    // buttons pressed faster than the loop settles
+    {"rapid", 600, {CTRL_BUTTON, CTRL_BUTTON, -CTRL_BUTTON, CTRL_BUTTON}, 4, 150, 0, 2500, 800, 40, 2000, 12},
+};
+
+#define NUM_GAIN_SETS   (sizeof(gain_sets) / sizeof(gain_sets[0]))
+#define NUM_SCENARIOS   (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/** @brief the loop's state and its target */
+static PIDParameters ctrl_pid = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, NULL};
+static uint32_t ctrl_target;
+
+/**
+ * @brief  one iteration of the loop; override drives the bridge BACKWARD
+ *         at full duty whatever the controller says
+ *
+*/
+static int32_t ctrl_iterate(int override, uint32_t *cycles, uint32_t *pos) {
+    uint32_t start = dwt_cycles();
+    uint32_t curr_pos = encoder_read();
+    int32_t error;
+    int32_t duty = pid_control_step(&ctrl_pid, curr_pos, ctrl_target, CTRL_PERIOD_MS / 1000.0f, &error);
+    if (override) {
+        motor_set_dir(MORTO_IN1_PORT, MORTO_IN2_PORT, MORTO_IN1_PIN, MORTO_IN2_PIN, PWM_TIMER, PWM_TIMER_CHANNEL, MAX_MOTOR_SPEED, BACKWARD);
+    } else {
+        motor_set_dir(MORTO_IN1_PORT, MORTO_IN2_PORT, MORTO_IN1_PIN, MORTO_IN2_PIN, PWM_TIMER, PWM_TIMER_CHANNEL,
+                      abs(duty), (duty >= 0) ? FORWARD : BACKWARD);
+    }
+    *cycles = dwt_cycles() - start;
+    *pos = curr_pos;
+    return duty;
+}
+
+/**
+ * @brief  run the loop on the current target for ms, nothing measured
+ *
+*/
+static void ctrl_hold(uint32_t ms) {
+    uint32_t cycles, pos;
+    for (uint32_t t = 0; t < ms; t += CTRL_PERIOD_MS) {
+        ctrl_iterate(0, &cycles, &pos);
+        vTaskDelay(pdMS_TO_TICKS(CTRL_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief  run one scenario and measure it
+ *
+*/
+static void ctrl_scenario(const ctrl_scenario_t *sc, ctrl_result_t *res) {
+    // unwrapped, with the start target at 0
+    int32_t move = 0;
+    for (uint32_t i = 0; i < sc->num_moves; i++) {
+        move += sc->moves[i];
+    }
+    uint32_t prev_pos = encoder_read();
+    int32_t pos = -findBestPath(prev_pos, ctrl_target);
+    int32_t first = pos;
+    int32_t dir = (move >= 0) ? 1 : -1;
+    uint32_t next_move = 0;
+    uint32_t settle_from = sc->shove ? CTRL_SHOVE_AT_MS + CTRL_SHOVE_MS : 0;
+    uint32_t sse_from = sc->window_ms - CTRL_SSE_MS;
+    uint32_t t10 = UINT32_MAX, t90 = UINT32_MAX, sse_sum = 0, sse_n = 0;
+    uint64_t cycles_sum = 0;
+    uint32_t n = 0;
+    int out = 0;
+
+    res->overshoot = 0;
+    res->settle_ms = 0;
+    res->peak_pwm = 0;
+    res->cycles_min = UINT32_MAX;
+    res->cycles_max = 0;
+
+    uint32_t start = dwt_cycles();
+    for (;;) {
+        uint32_t t = (dwt_cycles() - start) / CTRL_MS_CYCLES(1);
+        if (t >= sc->window_ms) {
+            break;
+        }
+        while (next_move < sc->num_moves && t >= next_move * sc->interval_ms) {
+            ctrl_target = (ctrl_target + sc->moves[next_move++] + TICKS_PER_REV) % TICKS_PER_REV;
+        }
+        int shoving = sc->shove && t >= CTRL_SHOVE_AT_MS && t < CTRL_SHOVE_AT_MS + CTRL_SHOVE_MS;
+
+        uint32_t cycles, curr_pos;
+        int32_t duty = ctrl_iterate(shoving, &cycles, &curr_pos);
+        pos += findBestPath(prev_pos, curr_pos);
+        prev_pos = curr_pos;
+
+        // against the final target
+        int32_t off = pos - move;
+        int32_t past = (move != 0) ? off * dir : abs(off);
+        int32_t done = (move != 0) ? (pos - first) * dir : 0;
+        if (move != 0 && t10 == UINT32_MAX && done * 10 >= (move - first) * dir) {
+            t10 = t;
+        }
+        if (move != 0 && t90 == UINT32_MAX && done * 10 >= (move - first) * dir * 9) {
+            t90 = t;
+        }
+        res->overshoot = (past > res->overshoot) ? past : res->overshoot;
+        out = abs(off) > CTRL_BAND;
+        if (out) {
+            res->settle_ms = (t > settle_from) ? (int32_t)(t - settle_from) : 0;
+        }
+        if (t >= sse_from) {
+            sse_sum += abs(off);
+            sse_n++;
+        }
+        res->peak_pwm = (abs(duty) > res->peak_pwm) ? abs(duty) : res->peak_pwm;
+        res->cycles_min = (cycles < res->cycles_min) ? cycles : res->cycles_min;
+        res->cycles_max = (cycles > res->cycles_max) ? cycles : res->cycles_max;
+        cycles_sum += cycles;
+        n++;
+
+        vTaskDelay(pdMS_TO_TICKS(CTRL_PERIOD_MS));
+    }
+
+    if (out) {
+        res->settle_ms = -1; // still out when the window closed
+    }
+    if (move == 0) {
+        res->rise_ms = 0;
+    } else {
+        res->rise_ms = (t90 == UINT32_MAX) ? -1 : (int32_t)(t90 - t10);
+    }
+    res->sse = (sse_n > 0) ? (int32_t)(sse_sum / sse_n) : -1;
+    res->cycles_mean = (n > 0) ? (uint32_t)(cycles_sum / n) : 0;
+}
+
+/**
+ * @brief  whether res is within the limits of sc
+ *
+*/
+static int ctrl_pass(const ctrl_scenario_t *sc, const ctrl_result_t *res) {
+    int rise_ok = (sc->num_moves == 0) || (res->rise_ms >= 0 && (uint32_t)res->rise_ms <= sc->max_rise_ms);
+    return rise_ok && (uint32_t)res->overshoot <= sc->max_overshoot
+        && res->settle_ms >= 0 && (uint32_t)res->settle_ms <= sc->max_settle_ms
+        && res->sse >= 0 && (uint32_t)res->sse <= sc->max_sse;
+}
+
+/**
+ * @brief  every scenario with every gain set
+ *
+*/
+static void vCtrlBenchTask(void *pvParameters) {
+    (void)pvParameters;
+    uint32_t passed = 0;
+    int shipped_ok = 1;
+
+    dwt_init();
+    printf("ctrl,gains,scenario,rise_ms,overshoot,settle_ms,sse,peak_pwm,min,mean,max,verdict\n");
+    for (uint32_t g = 0; g < NUM_GAIN_SETS; g++) {
+        xSemaphoreTake(ctrl_pid.mutex, portMAX_DELAY);
+        ctrl_pid.P = gain_sets[g].P;
+        ctrl_pid.I = gain_sets[g].I;
+        ctrl_pid.D = gain_sets[g].D;
+        ctrl_pid.integrator = 0.0f;
+        ctrl_pid.prevError = 0.0f;
+        xSemaphoreGive(ctrl_pid.mutex);
+
+        for (uint32_t s = 0; s < NUM_SCENARIOS; s++) {
+            const ctrl_scenario_t *sc = &scenarios[s];
+            ctrl_result_t res;
+            if (sc->start >= 0) {
+                ctrl_target = sc->start;
+            }
+            ctrl_hold(CTRL_HOLD_MS);
+            ctrl_scenario(sc, &res);
+
+            int pass = ctrl_pass(sc, &res);
+            passed += pass;
+            if (g == 0 && !pass) {
+                shipped_ok = 0;
+            }
+            printf("ctrl,%s,%s,", gain_sets[g].name, sc->name);
+            if (sc->num_moves == 0) {
+                printf("-,");
+            } else {
+                printf("%ld,", (long)res.rise_ms);
+            }
+            printf("%ld,%ld,%ld,%ld,%lu,%lu,%lu,%s\n", (long)res.overshoot, (long)res.settle_ms, (long)res.sse,
+                   (long)res.peak_pwm, (unsigned long)res.cycles_min, (unsigned long)res.cycles_mean,
+                   (unsigned long)res.cycles_max, pass ? "PASS" : "FAIL");
+        }
+    }
+    motor_set_dir(MORTO_IN1_PORT, MORTO_IN2_PORT, MORTO_IN1_PIN, MORTO_IN2_PIN, PWM_TIMER, PWM_TIMER_CHANNEL, 0, STOP);
+    printf("ctrl,done,%lu,%lu\n", (unsigned long)passed, (unsigned long)(NUM_GAIN_SETS * NUM_SCENARIOS));
+    // let the console drain before the run ends
+    vTaskDelay(pdMS_TO_TICKS(100));
+    exit(shipped_ok ? 0 : 1);
+}
+
+/**
+ * @brief main funtion
+ *
+*/
+int main( void ) {
+    uart_init(115200);
+    motor_init(MORTO_IN1_PORT, MORTO_IN2_PORT, MOTOR_EN_PORT, MORTO_IN1_PIN, MORTO_IN2_PIN, MOTOR_EN_PIN, PWM_TIMER, PWM_TIMER_CHANNEL, MOTOR_INIT_ALT);
+    ctrl_pid.mutex = xSemaphoreCreateMutex();
+    ctrl_target = encoder_read();
+
+    xTaskCreate(
+        vCtrlBenchTask,
+        "CtrlBench",
+        CTRL_STACK_WORDS,
+        NULL,
+        tskIDLE_PRIORITY + 2,
+        NULL);
+
+    vTaskStartScheduler();
+
+    // Infinite loop
+    for(;;) {}
+    return 0;
+}
@@ -0,0 +1,378 @@
+/**
+ * @file main.c
+ *
+ * @brief PROJ=rtosbench: DWT cycle costs of the FreeRTOS primitives the
+ *        firmware leans on
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "semphr.h"
+#include <stream_buffer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <uart.h>
+#include <nvic.h>
+#include <dwt.h>
+
+/*
+ * The report starts with the kernel configuration it was taken under,
+ *
+ *     rtos,config,<setting>,<value>
+ *
+ * then one line per measurement, in CPU cycles with the cost of reading
+ * the counter (the "overhead" line) taken off:
+ *
+ *     rtos,<measurement>,<runs>,<min>,<mean>,<max>
+ *
+ *   yield_switch      taskYIELD in one task to running in another of the
+ *                     same priority
+ *   mutex_take        xSemaphoreTake of a free mutex
+ *   mutex_give        xSemaphoreGive with nobody waiting
+ *   mutex_handoff     xSemaphoreGive in a lower priority holder to its
+ *                     waiter running, priority inheritance included
+ *   queue_roundtrip   one item to a higher priority echo task and back
+ *   stream_roundtrip  the same four bytes through two stream buffers
+ *   isr_entry         pending the IRQ to its handler running
+ *   isr_to_task       vTaskNotifyGiveFromISR in the handler to the
+ *                     notified task running
+ *
+ * Interrupts stay on, so max includes the tick. The IRQ is EXTI1's, pended
+ * from software through the NVIC; nothing else uses it. The run ends with
+ * "rtos,done" and exit(0), which stops make qemu and make host.
+ */
+
+/** @brief samples per measurement */
+#define RTOS_RUNS           (200)
+/** @brief stack of the benchmark task */
+#define RTOS_STACK_WORDS    (configMINIMAL_STACK_SIZE * 2)
+/** @brief the benchmark task, and the helpers around it */
+#define RTOS_PRIORITY       (tskIDLE_PRIORITY + 2)
+#define RTOS_PRIORITY_LOW   (tskIDLE_PRIORITY + 1)
+#define RTOS_PRIORITY_HIGH  (tskIDLE_PRIORITY + 3)
+
+/** @brief the IRQ pended from software, and its priority */
+#define RTOS_IRQ            (7)
+#define RTOS_IRQ_PRIORITY   (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY)
+
+/** @brief one measurement's samples */
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t runs;
+} rtos_stats_t;
+
+/** @brief what reading the counter twice costs, taken off every sample */
+static uint32_t rtos_overhead;
+
+/** @brief the benchmark task, for the helpers and the IRQ to notify */
+static TaskHandle_t bench_task;
+/** @brief the helper of the running measurement */
+static TaskHandle_t helper_task;
+
+/** @brief counter value a helper or the IRQ handed over */
+static volatile uint32_t stamp;
+/** @brief stamp is waiting to be taken */
+static volatile int stamp_armed;
+/** @brief handler entry, measured by the handler */
+static volatile uint32_t isr_entry;
+
+static rtos_stats_t yield_stats;
+static SemaphoreHandle_t bench_mutex;
+static QueueHandle_t request_queue, reply_queue;
+static StreamBufferHandle_t request_stream, reply_stream;
+
+static void rtos_stats_reset(rtos_stats_t *stats) {
+    stats->min = UINT32_MAX;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->runs = 0;
+}
+
+static void rtos_sample(rtos_stats_t *stats, uint32_t cycles) {
+    cycles = (cycles > rtos_overhead) ? cycles - rtos_overhead : 0;
+    stats->min = (cycles < stats->min) ? cycles : stats->min;
+    stats->max = (cycles > stats->max) ? cycles : stats->max;
+    stats->sum += cycles;
+    stats->runs++;
+}
+
+static void rtos_report(const char *name, const rtos_stats_t *stats) {
+    uint32_t mean = (stats->runs > 0) ? (uint32_t)(stats->sum / stats->runs) : 0;
+    printf("rtos,%s,%lu,%lu,%lu,%lu\n", name, (unsigned long)stats->runs,
+           (unsigned long)((stats->runs > 0) ? stats->min : 0), (unsigned long)mean, (unsigned long)stats->max);
+}
+
+/**
+ * @brief  start helper for one measurement
+ *
+*/
+static void rtos_helper_start(TaskFunction_t helper, UBaseType_t priority) {
+    xTaskCreate(helper, "Helper", configMINIMAL_STACK_SIZE, NULL, priority, &helper_task);
+}
+
+/**
+ * @brief  delete the helper, and let the idle task free it
+ *
+*/
+static void rtos_helper_stop(void) {
+    vTaskDelete(helper_task);
+    helper_task = NULL;
+    vTaskDelay(2);
+}
+
+/**
+ * @brief  the IRQ: how long it took to get here, then wake the benchmark task
+ *
+*/
+void EXTI1_IRQHandler(void) {
+    BaseType_t woken = pdFALSE;
+    isr_entry = dwt_cycles() - stamp;
+    stamp = dwt_cycles();
+    vTaskNotifyGiveFromISR(bench_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief  yield_switch: take the stamp of the task that just yielded
+ *
+*/
+static void rtos_yield_helper(void *pvParameters) {
+    (void)pvParameters;
+    for (;;) {
+        if (stamp_armed) {
+            rtos_sample(&yield_stats, dwt_cycles() - stamp);
+            stamp_armed = 0;
+        }
+        taskYIELD();
+    }
+}
+
+/**
+ * @brief  mutex_handoff: on each notification take the mutex, wake the
+ *         benchmark task to block on it, and give it over
+ *
+*/
+static void rtos_mutex_helper(void *pvParameters) {
+    (void)pvParameters;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xSemaphoreTake(bench_mutex, portMAX_DELAY);
+        xTaskNotifyGive(bench_task); // runs the benchmark task into the mutex
+        stamp = dwt_cycles();
+        xSemaphoreGive(bench_mutex);
+    }
+}
+
+/**
+ * @brief  queue_roundtrip: send every item straight back
+ *
+*/
+static void rtos_queue_helper(void *pvParameters) {
+    (void)pvParameters;
+    uint32_t item;
+    for (;;) {
+        xQueueReceive(request_queue, &item, portMAX_DELAY);
+        xQueueSend(reply_queue, &item, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief  stream_roundtrip: send every message straight back
+ *
+*/
+static void rtos_stream_helper(void *pvParameters) {
+    (void)pvParameters;
+    uint32_t item;
+    for (;;) {
+        xStreamBufferReceive(request_stream, &item, sizeof(item), portMAX_DELAY);
+        xStreamBufferSend(reply_stream, &item, sizeof(item), portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief  isr_entry, isr_to_task: pend the IRQ whenever the benchmark task
+ *         asks, once it is blocked waiting for the handler
+ *
+*/
+static void rtos_isr_helper(void *pvParameters) {
+    (void)pvParameters;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        stamp = dwt_cycles();
+        nvic_set_pending(RTOS_IRQ);
+    }
+}
+
+static void rtos_bench_yield(void) {
+    rtos_stats_reset(&yield_stats);
+    rtos_helper_start(rtos_yield_helper, RTOS_PRIORITY);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        stamp_armed = 1;
+        stamp = dwt_cycles();
+        taskYIELD();
+    }
+    rtos_helper_stop();
+    rtos_report("yield_switch", &yield_stats);
+}
+
+static void rtos_bench_mutex(void) {
+    rtos_stats_t take, give;
+    rtos_stats_reset(&take);
+    rtos_stats_reset(&give);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        uint32_t start = dwt_cycles();
+        xSemaphoreTake(bench_mutex, portMAX_DELAY);
+        uint32_t taken = dwt_cycles();
+        xSemaphoreGive(bench_mutex);
+        uint32_t given = dwt_cycles();
+        rtos_sample(&take, taken - start);
+        rtos_sample(&give, given - taken);
+    }
+    rtos_report("mutex_take", &take);
+    rtos_report("mutex_give", &give);
+}
+
+static void rtos_bench_mutex_handoff(void) {
+    rtos_stats_t handoff;
+    rtos_stats_reset(&handoff);
+    rtos_helper_start(rtos_mutex_helper, RTOS_PRIORITY_LOW);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        xTaskNotifyGive(helper_task);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // the helper holds the mutex
+        xSemaphoreTake(bench_mutex, portMAX_DELAY);
+        rtos_sample(&handoff, dwt_cycles() - stamp);
+        xSemaphoreGive(bench_mutex);
+    }
+    rtos_helper_stop();
+    rtos_report("mutex_handoff", &handoff);
+}
+
+static void rtos_bench_queue(void) {
+    rtos_stats_t roundtrip;
+    uint32_t item = 0;
+    rtos_stats_reset(&roundtrip);
+    rtos_helper_start(rtos_queue_helper, RTOS_PRIORITY_HIGH);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        uint32_t start = dwt_cycles();
+        xQueueSend(request_queue, &item, portMAX_DELAY);
+        xQueueReceive(reply_queue, &item, portMAX_DELAY);
+        rtos_sample(&roundtrip, dwt_cycles() - start);
+    }
+    rtos_helper_stop();
+    rtos_report("queue_roundtrip", &roundtrip);
+}
+
+static void rtos_bench_stream(void) {
+    rtos_stats_t roundtrip;
+    uint32_t item = 0;
+    rtos_stats_reset(&roundtrip);
+    rtos_helper_start(rtos_stream_helper, RTOS_PRIORITY_HIGH);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        uint32_t start = dwt_cycles();
+        xStreamBufferSend(request_stream, &item, sizeof(item), portMAX_DELAY);
+        xStreamBufferReceive(reply_stream, &item, sizeof(item), portMAX_DELAY);
+        rtos_sample(&roundtrip, dwt_cycles() - start);
+    }
+    rtos_helper_stop();
+    rtos_report("stream_roundtrip", &roundtrip);
+}
+
+static void rtos_bench_isr(void) {
+    rtos_stats_t entry, to_task;
+    rtos_stats_reset(&entry);
+    rtos_stats_reset(&to_task);
+    nvic_set_priority(RTOS_IRQ, RTOS_IRQ_PRIORITY);
+    nvic_irq(RTOS_IRQ, IRQ_ENABLE);
+    rtos_helper_start(rtos_isr_helper, RTOS_PRIORITY_LOW);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        xTaskNotifyGive(helper_task);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        rtos_sample(&to_task, dwt_cycles() - stamp);
+        rtos_sample(&entry, isr_entry);
+    }
+    rtos_helper_stop();
+    nvic_irq(RTOS_IRQ, IRQ_DISABLE);
+    rtos_report("isr_entry", &entry);
+    rtos_report("isr_to_task", &to_task);
+}
+
+/**
+ * @brief  the configuration the numbers belong to
+ *
+*/
+static void rtos_config(void) {
+    printf("rtos,config,cpu_hz,%lu\n", (unsigned long)configCPU_CLOCK_HZ);
+    printf("rtos,config,tick_hz,%lu\n", (unsigned long)configTICK_RATE_HZ);
+    printf("rtos,config,preemption,%d\n", configUSE_PREEMPTION);
+    printf("rtos,config,max_priorities,%d\n", configMAX_PRIORITIES);
+    printf("rtos,config,port_optimised_task_selection,%d\n", configUSE_PORT_OPTIMISED_TASK_SELECTION);
+    printf("rtos,config,newlib_reentrant,%d\n", configUSE_NEWLIB_REENTRANT);
+    printf("rtos,config,trace_facility,%d\n", configUSE_TRACE_FACILITY);
+    printf("rtos,config,max_syscall_irq_priority,%d\n", configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+}
+
+/**
+ * @brief  measure the counter, then every primitive
+ *
+*/
+static void vRtosBenchTask(void *pvParameters) {
+    (void)pvParameters;
+    rtos_stats_t overhead;
+
+    dwt_init();
+    rtos_config();
+    printf("rtos,measurement,runs,min,mean,max\n");
+    rtos_stats_reset(&overhead);
+    for (uint32_t i = 0; i < RTOS_RUNS; i++) {
+        uint32_t start = dwt_cycles();
+        rtos_sample(&overhead, dwt_cycles() - start);
+    }
+    rtos_report("overhead", &overhead);
+    rtos_overhead = overhead.min;
+
+    rtos_bench_yield();
+    rtos_bench_mutex();
+    rtos_bench_mutex_handoff();
+    rtos_bench_queue();
+    rtos_bench_stream();
+    rtos_bench_isr();
+
+    printf("rtos,done\n");
+    // let the console drain before the run ends
+    vTaskDelay(pdMS_TO_TICKS(100));
+    exit(0);
+}
+
+/**
+ * @brief main funtion
+ *
+*/
+int main( void ) {
+    uart_init(115200);
+    bench_mutex = xSemaphoreCreateMutex();
+    request_queue = xQueueCreate(1, sizeof(uint32_t));
+    reply_queue = xQueueCreate(1, sizeof(uint32_t));
+    request_stream = xStreamBufferCreate(2 * sizeof(uint32_t), sizeof(uint32_t));
+    reply_stream = xStreamBufferCreate(2 * sizeof(uint32_t), sizeof(uint32_t));
+
+    xTaskCreate(
+        vRtosBenchTask,
+        "RtosBench",
+        RTOS_STACK_WORDS,
+        NULL,
+        RTOS_PRIORITY,
+        &bench_task);
+
+    vTaskStartScheduler();
+
+    // Infinite loop
+    for(;;) {}
+    return 0;
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Decoding of the board's console stream: printf text mixed with COBS
+framed binary records, see include/telemetry.h."""
+
+import struct
+
+# Frame types, see include/telemetry.h
+FRAME_SAMPLE = 0x01
+FRAME_LOG = 0x02
+
+# timestamp, position, target, error, pwm (little endian)
+SAMPLE = struct.Struct('<Iiiih')
+
+
+def crc16_ccitt(buf, crc=0xFFFF):
+    for b in buf:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(buf):
+    out = bytearray()
+    i = 0
+    while i < len(buf):
+        code = buf[i]
+        if code == 0 or i + code > len(buf):
+            return None
+        out += buf[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(buf):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(buf):
+    """Return (type, payload) if buf is a complete COBS frame with a good CRC."""
+    raw = cobs_decode(buf)
+    if raw is None or len(raw) < 3:
+        return None
+    if crc16_ccitt(raw[:-2]) != struct.unpack('<H', raw[-2:])[0]:
+        return None
+    return raw[0], raw[1:-2]
+
+
+def split_chunk(chunk):
+    """A chunk between two zeros is optional printf text followed by at most
+    one frame. The frame is the longest suffix that decodes with a valid CRC."""
+    for start in range(len(chunk)):
+        frame = decode_frame(chunk[start:])
+        if frame is not None:
+            return chunk[:start], frame
+    return chunk, None
+
+
+class StreamDecoder:
+    """Feed raw bytes, get back (text, frame) pairs for every complete chunk."""
+
+    def __init__(self):
+        self.rx = bytearray()
+
+    def feed(self, data):
+        self.rx.extend(data)
+        while True:
+            end = self.rx.find(b'\x00')
+            if end < 0:
+                return
+            chunk = bytes(self.rx[:end])
+            del self.rx[:end + 1]
+            yield split_chunk(chunk)
@@ -1,42 +1,58 @@
 #!/usr/bin/env python3
 
-from datetime import datetime
 import serial
 import matplotlib.pyplot as plt
 from matplotlib.animation import FuncAnimation
 import collections
-import re
+import sys
+from frames import FRAME_LOG, FRAME_SAMPLE, SAMPLE, StreamDecoder
+from logdecode import LogFormatter
 
-# Open serial port
-ser = serial.Serial('/dev/cu.usbmodem145303', 115200)
+# Open serial port at the power-on rate, then ask the board to speed up
+BOOT_BAUD = 115200
+LINK_BAUD = 921600
+ser = serial.Serial('/dev/cu.usbmodem145303', BOOT_BAUD, timeout=1)
+if LINK_BAUD != BOOT_BAUD:
+    ser.write(b'AT+BAUD=%d\n' % LINK_BAUD)
+    # the board answers OK at the old rate and switches once it is sent
+    while True:
+        reply = ser.readline()
+        if not reply or b'OK' in reply:
+            break
+    if reply:
+        ser.flush()
+        ser.baudrate = LINK_BAUD
+    ser.reset_input_buffer()
+ser.timeout = None
 
 # Store tuples of (timestamp, motor_position)
 data = collections.deque(maxlen=500)
-motor_pattern = re.compile(r"Motor_position = (\d+)")
-target_pattern = re.compile(r"Target_position = (\d+)")
 
 target_position = None  # Initialize target position
+stream = StreamDecoder()
+# pass the firmware ELF to also see LOG() messages
+log_formatter = LogFormatter(sys.argv[1]) if len(sys.argv) > 1 else None
 
-def animate(i):
+
+def handle_frame(ftype, payload):
     global target_position
+    if ftype == FRAME_SAMPLE and len(payload) == SAMPLE.size:
+        timestamp, position, target, _error, pwm = SAMPLE.unpack(payload)
+        data.append((timestamp, position))
+        target_position = target
+    elif ftype == FRAME_LOG and log_formatter is not None:
+        timestamp, line = log_formatter.format(payload)
+        sys.stdout.write('[%8.3f] %s' % (timestamp / 1000.0, line))
+
+
+def animate(i):
     # If there's data available in the serial buffer
-    while ser.in_waiting:
-        try:
-            line = ser.readline().decode('utf-8').strip()
-            motor_match = motor_pattern.search(line)
-            target_match = target_pattern.search(line)
-            
-            if motor_match:
-                position = int(motor_match.group(1))
-                timestamp = datetime.now().timestamp() * 1000  # Convert to milliseconds
-                data.append((timestamp, position))
-            
-            if target_match:
-                # Update target position
-                target_position = int(target_match.group(1))
-                
-        except ValueError:
-            continue
+    incoming = ser.read(ser.in_waiting) if ser.in_waiting else b''
+    for text, frame in stream.feed(incoming):
+        if text:
+            sys.stdout.write(text.decode('utf-8', errors='replace'))
+        if frame is not None:
+            handle_frame(*frame)
 
     ax.clear()
     if data:
@@ -44,13 +60,13 @@ def animate(i):
         ax.plot(timestamps, positions, label='Motor Position')
         if target_position is not None:
             ax.axhline(y=target_position, color='r', label='Target Position')
-        
+
         latest_time = data[-1][0]  # Latest timestamp in data
         ax.set_xlim(latest_time - 1000, latest_time)
 
     # Set fixed y-axis range
     ax.set_ylim(0, 1200)
-    
+
     plt.xlabel('Timestamp (ms)')
     plt.ylabel('Motor Position')
     plt.legend()
@@ -60,4 +76,4 @@ fig, ax = plt.subplots()
 ani = FuncAnimation(fig, animate, interval=10)
 plt.tight_layout()
 plt.show()
-ser.close()
\ No newline at end of file
+ser.close()
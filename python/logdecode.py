@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Rebuild LOG() messages from the board's console stream.
+
+The firmware only sends the address of each format string (in the
+non-loaded .logstr section), a timestamp and the raw 32-bit arguments.
+This tool reads the strings back out of the ELF and formats them here.
+
+usage: logdecode.py build/bin/<binary>.elf [serial port | capture file] [baud]
+"""
+
+import re
+import struct
+import sys
+from frames import FRAME_LOG, StreamDecoder
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 0x2
+STT_FUNC = 2
+
+# %[flags][width][.precision][length]conversion
+SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcfFeEgGsp%])')
+
+
+class Elf:
+    """Just enough of an ELF32/ELF64 reader to find sections by name."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+        is64 = self.data[4] == 2
+        end = '<' if self.data[5] == 1 else '>'
+        self.is64 = is64
+        self.end = end
+        if is64:
+            shoff, = struct.unpack_from(end + 'Q', self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(end + 'HHH', self.data, 0x3A)
+            shdr = struct.Struct(end + 'IIQQQQIIQQ')
+        else:
+            shoff, = struct.unpack_from(end + 'I', self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(end + 'HHH', self.data, 0x2E)
+            shdr = struct.Struct(end + 'IIIIIIIIII')
+        raw = [shdr.unpack_from(self.data, shoff + i * shentsize) for i in range(shnum)]
+        names = raw[shstrndx]
+        self.sections = []
+        for name, stype, flags, addr, offset, size, *_ in raw:
+            start = names[4] + name
+            sname = self.data[start:self.data.index(b'\0', start)].decode()
+            self.sections.append((sname, stype, flags, addr, offset, size))
+
+    def section(self, name):
+        for s in self.sections:
+            if s[0] == name:
+                return s
+        return None
+
+    def cstring(self, section, addr):
+        _, _, _, base, offset, size = section
+        if not base <= addr < base + size:
+            return None
+        start = offset + addr - base
+        return self.data[start:self.data.index(b'\0', start)].decode('utf-8', errors='replace')
+
+    def string_at(self, addr):
+        """NUL terminated string at a load address, for %s arguments."""
+        for s in self.sections:
+            if s[1] == SHT_PROGBITS and s[2] & SHF_ALLOC and s[3] <= addr < s[3] + s[5]:
+                return self.cstring(s, addr)
+        return None
+
+    def functions(self):
+        """Sorted (address, size, name) of the function symbols in .symtab,
+        Thumb bit cleared."""
+        symtab = self.section('.symtab')
+        strtab = self.section('.strtab')
+        if symtab is None or strtab is None:
+            return []
+        if self.is64:
+            sym = struct.Struct(self.end + 'IBBHQQ')
+        else:
+            sym = struct.Struct(self.end + 'IIIBBH')
+        funcs = []
+        for off in range(symtab[4], symtab[4] + symtab[5], sym.size):
+            if self.is64:
+                name, info, _, _, value, size = sym.unpack_from(self.data, off)
+            else:
+                name, value, size, info, _, _ = sym.unpack_from(self.data, off)
+            if info & 0xF != STT_FUNC or value == 0:
+                continue
+            start = strtab[4] + name
+            funcs.append((value & ~1, size, self.data[start:self.data.index(b'\0', start)].decode()))
+        funcs.sort()
+        return funcs
+
+
+class LogFormatter:
+    def __init__(self, elf_path):
+        self.elf = Elf(elf_path)
+        self.logstr = self.elf.section('.logstr')
+        if self.logstr is None:
+            raise ValueError('%s has no .logstr section' % elf_path)
+
+    def convert(self, spec, word):
+        flags, width, prec, _length, conv = spec.groups()
+        pyspec = '%' + flags + width + ('.' + prec if prec is not None else '')
+        if conv in 'di':
+            return (pyspec + 'd') % struct.unpack('<i', struct.pack('<I', word))[0]
+        if conv in 'ouxX':
+            return (pyspec + conv.replace('u', 'd')) % word
+        if conv == 'p':
+            return '0x%08x' % word
+        if conv == 'c':
+            return (pyspec + 'c') % chr(word & 0xFF)
+        if conv in 'fFeEgG':
+            return (pyspec + conv) % struct.unpack('<f', struct.pack('<I', word))[0]
+        text = self.elf.string_at(word)
+        return (pyspec + 's') % (text if text is not None else '<0x%08x>' % word)
+
+    def format(self, payload):
+        """Turn a FRAME_LOG payload into (timestamp, text)."""
+        fid, timestamp = struct.unpack_from('<II', payload)
+        args = list(struct.unpack_from('<%dI' % ((len(payload) - 8) // 4), payload, 8))
+        fmt = self.elf.cstring(self.logstr, fid)
+        if fmt is None:
+            return timestamp, '<unknown log id 0x%x> %r\n' % (fid, args)
+
+        def repl(m):
+            if m.group(5) == '%':
+                return '%'
+            return self.convert(m, args.pop(0)) if args else '<missing>'
+        return timestamp, SPEC.sub(repl, fmt)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    fmt = LogFormatter(sys.argv[1])
+    source = sys.argv[2]
+    if source.startswith('/dev/'):
+        import serial
+        baud = int(sys.argv[3]) if len(sys.argv) > 3 else 115200
+        port = serial.Serial(source, baud)
+        read = lambda: port.read(max(1, port.in_waiting))
+    else:
+        capture = open(source, 'rb')
+        read = lambda: capture.read(4096)
+
+    stream = StreamDecoder()
+    while True:
+        data = read()
+        if not data:
+            break
+        for text, frame in stream.feed(data):
+            if text:
+                sys.stdout.write(text.decode('utf-8', errors='replace'))
+            if frame is not None and frame[0] == FRAME_LOG:
+                timestamp, line = fmt.format(frame[1])
+                sys.stdout.write('[%8.3f] %s' % (timestamp / 1000.0, line))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
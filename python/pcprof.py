@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Symbolize the PC histogram of a PC_PROFILE=1 build.
+
+The firmware only counts sampled PCs in fixed-size buckets of .text (see
+include/pcprof.h). This tool asks for the histogram with AT+PCPROF, or reads
+it from a capture of the console, and charges every bucket to the function
+of the ELF that covers most of it, so a function smaller than a bucket may
+be merged into its neighbour. It prints the share of samples per task and
+per function, largest first.
+
+usage: pcprof.py build/bin/<binary>.elf [serial port | capture file] [baud]
+"""
+
+import bisect
+import collections
+import sys
+from frames import StreamDecoder
+from logdecode import Elf
+
+
+class Symbolizer:
+    def __init__(self, elf_path):
+        self.funcs = Elf(elf_path).functions()
+        if not self.funcs:
+            raise ValueError('%s has no symbol table' % elf_path)
+        self.starts = [f[0] for f in self.funcs]
+
+    def name(self, addr, size):
+        """Function that overlaps most of [addr, addr + size)."""
+        best, best_overlap = None, 0
+        i = max(0, bisect.bisect_right(self.starts, addr) - 1)
+        while i < len(self.funcs) and self.funcs[i][0] < addr + size:
+            start, fsize, fname = self.funcs[i]
+            overlap = min(addr + size, start + max(fsize, 1)) - max(addr, start)
+            if overlap > best_overlap:
+                best, best_overlap = fname, overlap
+            i += 1
+        return best if best is not None else '<0x%08x>' % addr
+
+
+def read_dump(read):
+    """Collect the pcprof,... lines up to pcprof,end."""
+    stream = StreamDecoder()
+    text = ''
+    lines = []
+    while True:
+        data = read()
+        if not data:
+            break
+        for chunk, _frame in stream.feed(data):
+            text += chunk.decode('utf-8', errors='replace')
+        *done, text = text.replace('\r', '').split('\n')
+        for line in done:
+            if line.startswith('pcprof,'):
+                lines.append(line.split(','))
+                if line == 'pcprof,end':
+                    return lines
+    return lines
+
+
+def report(lines, symbols):
+    header = next((l for l in lines if l[1] == 'hz'), None)
+    if header is None:
+        sys.exit('no pcprof dump found; is the firmware built with PC_PROFILE=1?')
+    hz, samples, shift = int(header[2]), int(header[4]), int(header[8])
+    if samples == 0:
+        sys.exit('no samples yet')
+
+    print('%d samples at %d Hz (%.1f s), %d byte buckets\n' % (samples, hz, samples / hz, 1 << shift))
+    tasks = [(int(l[3]), l[2]) for l in lines if l[1] == 'task']
+    print('%7s %6s  task' % ('samples', '%'))
+    for count, name in sorted(tasks, reverse=True):
+        print('%7d %6.2f  %s' % (count, 100.0 * count / samples, name))
+
+    funcs = collections.Counter()
+    for l in lines:
+        if l[1] != 'pc':
+            continue
+        addr, count = int(l[2], 16), int(l[3])
+        funcs[symbols.name(addr, 1 << shift) if addr else '<outside .text>'] += count
+    print('\n%7s %6s  function' % ('samples', '%'))
+    for name, count in funcs.most_common():
+        print('%7d %6.2f  %s' % (count, 100.0 * count / samples, name))
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    symbols = Symbolizer(sys.argv[1])
+    source = sys.argv[2]
+    if source.startswith('/dev/'):
+        import serial
+        baud = int(sys.argv[3]) if len(sys.argv) > 3 else 115200
+        port = serial.Serial(source, baud, timeout=2)
+        port.reset_input_buffer()
+        port.write(b'AT+PCPROF\r\n')
+        read = lambda: port.read(max(1, port.in_waiting))
+    else:
+        capture = open(source, 'rb')
+        read = lambda: capture.read(4096)
+    report(read_dump(read), symbols)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,235 @@
+/**
+ * @file   sim.c
+ *
+ * @brief  Host build: peripheral memory, the hardware thread and the
+ *         register access hooks
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <sim.h>
+
+/** @brief address ranges the drivers touch, mapped at their real addresses */
+static const struct {
+    uintptr_t base;
+    size_t size;
+} sim_regions[] = {
+    {0x40000000, 0x00030000},   // APB1, APB2 and AHB1 peripherals
+    {0xE0000000, 0x00100000},   // Cortex-M4 private peripherals (NVIC, SCB, DWT)
+};
+
+/** @brief every simulated peripheral */
+static const sim_model_t *const sim_models[] = {
+    &sim_core_model,
+    &sim_gpio_model,
+    &sim_tim_model,
+    &sim_uart_model,
+    &sim_i2c_model,
+    &sim_adc_model,
+    &sim_replay_model,
+    &sim_motor_model,
+};
+
+#define SIM_MODEL_COUNT (sizeof(sim_models) / sizeof(sim_models[0]))
+
+/** @brief serializes the models between the hardware thread and the drivers */
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief CLOCK_MONOTONIC at start-up */
+static struct timespec sim_epoch;
+
+/**
+ * @brief ns of host time since start-up
+ */
+uint64_t sim_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - sim_epoch.tv_sec) * 1000000000ULL + now.tv_nsec - sim_epoch.tv_nsec;
+}
+
+/**
+ * @brief SIM_STATS=1 in the environment asks for the exit report
+ */
+int sim_stats_enabled(void) {
+    const char *env = getenv("SIM_STATS");
+    return env != NULL && env[0] != '\0' && env[0] != '0';
+}
+
+/**
+ * @brief run every model's stop hook, once, however the simulation ends
+ */
+static void sim_stop(void) {
+    static volatile sig_atomic_t stopped;
+    if (stopped) {
+        return;
+    }
+    stopped = 1;
+    uint64_t now = sim_now_ns();
+    for (size_t i = 0; i < SIM_MODEL_COUNT; i++) {
+        if (sim_models[i]->stop != NULL) {
+            sim_models[i]->stop(now);
+        }
+    }
+}
+
+/**
+ * @brief ^C or SIGTERM: the scheduler never returns, so this is the way out
+ */
+static void sim_stop_signal(int sig) {
+    sim_stop();
+    _exit(128 + sig);
+}
+
+/**
+ * @brief print a simulator error and exit
+ */
+void sim_fatal(const char *fmt, ...) {
+    va_list ap;
+    fputs("\r\nsim: ", stderr);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputs("\r\n", stderr);
+    exit(1);
+}
+
+/**
+ * @brief configASSERT on the host: say where, then stop
+ */
+void sim_assert_failed(const char *file, int line) {
+    sim_fatal("assertion failed at %s:%d", file, line);
+}
+
+/**
+ * @brief take the model lock with every signal blocked
+ */
+void sim_lock(sigset_t *saved) {
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, saved);
+    pthread_mutex_lock(&sim_mutex);
+}
+
+/**
+ * @brief drop the model lock and restore the caller's signal mask
+ */
+void sim_unlock(const sigset_t *saved) {
+    pthread_mutex_unlock(&sim_mutex);
+    pthread_sigmask(SIG_SETMASK, saved, NULL);
+}
+
+/**
+ * @brief hand a marked register access to the models
+ */
+static void sim_access(volatile void *reg, int write) {
+    sigset_t saved;
+    sim_lock(&saved);
+    uint64_t now = sim_now_ns();
+    for (size_t i = 0; i < SIM_MODEL_COUNT; i++) {
+        if (sim_models[i]->access != NULL) {
+            sim_models[i]->access((uintptr_t)reg, write, now);
+        }
+    }
+    sim_unlock(&saved);
+}
+
+/** @brief MMIO_WRITTEN(reg) in the host build */
+void sim_reg_written(volatile void *reg) {
+    sim_access(reg, 1);
+}
+
+/** @brief MMIO_READ(reg) in the host build */
+void sim_reg_read(volatile void *reg) {
+    sim_access(reg, 0);
+}
+
+/**
+ * @brief the "hardware": steps every model each SIM_STEP_NS. It runs with
+ *        every signal blocked, interrupts always land on the task thread.
+ */
+static void *sim_hw_thread(void *arg) {
+    (void)arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (;;) {
+        next.tv_nsec += SIM_STEP_NS;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        sigset_t saved;
+        sim_lock(&saved);
+        uint64_t now = sim_now_ns();
+        for (size_t i = 0; i < SIM_MODEL_COUNT; i++) {
+            if (sim_models[i]->step != NULL) {
+                sim_models[i]->step(now);
+            }
+        }
+        sim_unlock(&saved);
+    }
+    return NULL;
+}
+
+/**
+ * @brief map the register ranges, reset the models and power the hardware up,
+ *        all before the firmware's main() runs
+ */
+__attribute__((constructor)) static void sim_start(void) {
+    clock_gettime(CLOCK_MONOTONIC, &sim_epoch);
+
+    for (size_t i = 0; i < sizeof(sim_regions) / sizeof(sim_regions[0]); i++) {
+        void *want = (void *)sim_regions[i].base;
+        void *got = mmap(want, sim_regions[i].size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (got != want) {
+            sim_fatal("cannot map registers at %p: %s", want,
+                      (got == MAP_FAILED) ? strerror(errno) : "address taken");
+        }
+    }
+
+    for (size_t i = 0; i < SIM_MODEL_COUNT; i++) {
+        if (sim_models[i]->reset != NULL) {
+            sim_models[i]->reset();
+        }
+    }
+    sim_irq_init();
+
+    atexit(sim_stop);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sim_stop_signal;
+    sigfillset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // the new thread inherits the mask. The POSIX port blocks everything but
+    // SIGINT in the task threads, so this is where SIGTERM lands
+    sigset_t all, saved;
+    sigfillset(&all);
+    sigdelset(&all, SIGINT);
+    sigdelset(&all, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &all, &saved);
+    pthread_t hw;
+    int err = pthread_create(&hw, NULL, sim_hw_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+    if (err != 0) {
+        sim_fatal("cannot start the hardware thread: %s", strerror(err));
+    }
+    pthread_detach(hw);
+}
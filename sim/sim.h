@@ -0,0 +1,160 @@
+/**
+ * @file   sim.h
+ *
+ * @brief  Host build: simulated STM32F401 register blocks and interrupts
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stdint.h>
+#include <signal.h>
+#include <sys/types.h>
+
+/*
+ * The peripheral address ranges are mapped as ordinary memory at their real
+ * addresses before main() runs, so the drivers keep their hard-coded base
+ * addresses. Behaviour lives in models: each one gets a periodic step from
+ * the "hardware" thread and sees the accesses the drivers mark with
+ * MMIO_WRITTEN / MMIO_READ (include/mmio.h). Models run under one lock, with
+ * every signal blocked, and raise interrupts with sim_irq_raise().
+ */
+
+/** @brief period of the hardware thread, in ns of host time */
+#define SIM_STEP_NS         (100000)
+
+/** @brief the core clock the firmware believes in (RCC left at HSI) */
+#define SIM_CPU_HZ          (16000000)
+
+/** @brief number of external interrupt lines (NVIC ISER0..2) */
+#define SIM_IRQ_COUNT       (96)
+
+/** @brief a 32-bit register at a simulated address */
+#define SIM_REG(addr)       (*(volatile uint32_t *)(uintptr_t)(addr))
+
+/*
+ * Set / clear status bits the firmware may clear with a read-modify-write of
+ * its own at the same time (TIMx SR, ...). The firmware side still races,
+ * as it would against real hardware, but the model never loses a bit.
+ */
+#define SIM_SET_BITS(addr, bits) __atomic_fetch_or(&SIM_REG(addr), (uint32_t)(bits), __ATOMIC_SEQ_CST)
+#define SIM_CLR_BITS(addr, bits) __atomic_fetch_and(&SIM_REG(addr), ~(uint32_t)(bits), __ATOMIC_SEQ_CST)
+
+/** @brief one simulated peripheral */
+typedef struct {
+    /** @brief shown in fatal errors */
+    const char *name;
+    /** @brief put the registers in their power-on state, before main() */
+    void (*reset)(void);
+    /** @brief advance the model to now_ns, from the hardware thread */
+    void (*step)(uint64_t now_ns);
+    /** @brief a driver marked an access to addr; models ignore foreign addresses */
+    void (*access)(uintptr_t addr, int write, uint64_t now_ns);
+    /** @brief the simulation is ending: put the host back, report if SIM_STATS is set */
+    void (*stop)(uint64_t now_ns);
+} sim_model_t;
+
+/* models, listed in sim.c */
+extern const sim_model_t sim_core_model;
+extern const sim_model_t sim_gpio_model;
+extern const sim_model_t sim_tim_model;
+extern const sim_model_t sim_uart_model;
+extern const sim_model_t sim_i2c_model;
+extern const sim_model_t sim_adc_model;
+extern const sim_model_t sim_replay_model;
+extern const sim_model_t sim_motor_model;
+
+/*
+ * Time since start-up in ns of host time. Everything simulated runs in real
+ * time, so the firmware's own FreeRTOS tick and the models agree.
+ */
+uint64_t sim_now_ns(void);
+
+/*
+ * The model lock. Every signal stays blocked while it is held, so neither
+ * the tick nor a simulated interrupt can switch tasks under it.
+ */
+void sim_lock(sigset_t *saved);
+void sim_unlock(const sigset_t *saved);
+
+/*
+ * Mark irq pending in the NVIC. If it is enabled the CPU takes it as soon as
+ * the running task leaves any critical section. Caller holds the model lock.
+ */
+void sim_irq_raise(int irq);
+
+/*
+ * Install the interrupt signal handler, from the constructor
+ */
+void sim_irq_init(void);
+
+/*
+ * What the world outside the chip does to a pin (port 0 = GPIOA): drive it
+ * to level, or let go of it so it floats to its pull-up / pull-down. A
+ * change of level reaches EXTI like a real edge. Caller holds the model lock.
+ */
+void sim_gpio_drive(int port, int pin, int level);
+void sim_gpio_release(int port, int pin);
+
+/*
+ * A pin changed level, for the timer inputs that follow it (TIM1 CH1/CH2 in
+ * encoder mode). Called by the GPIO model. Caller holds the model lock.
+ */
+void sim_tim_input(int port, int pin);
+
+/*
+ * Level the firmware puts out on a pin (ODR). Caller holds the model lock.
+ */
+int sim_gpio_output(int port, int pin);
+
+/*
+ * Voltage on ADC1 input chan, in mV against a 3.3 V reference. Caller holds
+ * the model lock.
+ */
+void sim_adc_set(int chan, uint32_t mv);
+
+/*
+ * Host time the firmware last wrote DWT_CYCCNT (trace_init zeroes it), 0
+ * if it never did. Caller holds the model lock.
+ */
+uint64_t sim_dwt_epoch_ns(void);
+
+/*
+ * Queue len bytes for the USART2 RX line, after whatever is already
+ * waiting; they go out at the line rate. Returns how many fit. Caller holds
+ * the model lock.
+ */
+size_t sim_uart_inject(const uint8_t *data, size_t len, uint64_t now_ns);
+
+/*
+ * One frame on the USART2 line at the current baud rate, in ns
+ */
+uint64_t sim_uart_frame_ns(void);
+
+/*
+ * True if SIM_REPLAY drives the encoder pins, in which case the motor
+ * plant leaves them alone
+ */
+int sim_replay_encoder(void);
+
+/*
+ * True if the SIM_STATS environment variable asks for the exit report
+ */
+int sim_stats_enabled(void);
+
+/*
+ * Print a simulator error and exit
+ */
+void sim_fatal(const char *fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+/*
+ * The real read / write: the firmware's own read(0) / write(1) go to the
+ * simulated USART2 instead (see sim_uart.c)
+ */
+ssize_t __real_read(int fd, void *buf, size_t len);
+ssize_t __real_write(int fd, const void *buf, size_t len);
+
+#endif /* _SIM_H_ */
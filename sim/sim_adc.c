@@ -0,0 +1,133 @@
+/**
+ * @file   sim_adc.c
+ *
+ * @brief  Host build: ADC1 single regular conversions
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <string.h>
+#include <sim.h>
+
+/*
+ * SWSTART converts the first channel of the regular sequence (SQR3 SQ1).
+ * EOC comes up after the sample time of that channel plus the resolution's
+ * conversion cycles at ADCCLK = APB2 / ADCPRE, and reading DR clears it.
+ * The inputs hold whatever sim_adc_set() put on them.
+ */
+
+#define ADC1_SR         (0x40012000)
+#define ADC1_CR1        (0x40012004)
+#define ADC1_CR2        (0x40012008)
+#define ADC1_SMPR1      (0x4001200C)
+#define ADC1_SMPR2      (0x40012010)
+#define ADC1_SQR3       (0x40012034)
+#define ADC1_DR         (0x4001204C)
+#define ADC_CCR         (0x40012304)
+#define ADC_SR_EOC      (1 << 1)
+#define ADC_SR_STRT     (1 << 4)
+#define ADC_CR1_EOCIE   (1 << 5)
+#define ADC_CR2_ADON    (1 << 0)
+#define ADC_CR2_SWSTART (1 << 30)
+#define ADC_IRQ         (18)
+#define ADC_CHANNELS    (19)
+#define ADC_VREF_MV     (3300)
+
+/** @brief sampling time in ADCCLK cycles for each SMPx code */
+static const uint32_t adc_sample_cycles[8] = {3, 15, 28, 56, 84, 112, 144, 480};
+
+/** @brief what sits on each input, in mV */
+static uint32_t adc_mv[ADC_CHANNELS];
+
+/** @brief conversion in flight, and when it is done */
+static int converting;
+static uint64_t done_ns;
+
+void sim_adc_set(int chan, uint32_t mv) {
+    if (chan >= 0 && chan < ADC_CHANNELS) {
+        adc_mv[chan] = (mv > ADC_VREF_MV) ? ADC_VREF_MV : mv;
+    }
+}
+
+/**
+ * @brief the channel of the first regular conversion
+ */
+static int adc_channel(void) {
+    return SIM_REG(ADC1_SQR3) & 0x1F;
+}
+
+/**
+ * @brief result bits from CR1 RES: 12, 10, 8 or 6
+ */
+static int adc_bits(void) {
+    return 12 - 2 * (int)((SIM_REG(ADC1_CR1) >> 24) & 0x3);
+}
+
+/**
+ * @brief how long one conversion of chan takes, in ns
+ */
+static uint64_t adc_conversion_ns(int chan) {
+    uint32_t smpr = (chan >= 10) ? SIM_REG(ADC1_SMPR1) : SIM_REG(ADC1_SMPR2);
+    uint32_t smp = (smpr >> (3 * (chan % 10))) & 0x7;
+    uint32_t prescaler = 2 * (((SIM_REG(ADC_CCR) >> 16) & 0x3) + 1);
+    uint64_t cycles = adc_sample_cycles[smp] + adc_bits();
+    return cycles * prescaler * 1000000000ULL / SIM_CPU_HZ;
+}
+
+/**
+ * @brief light on A0 at half scale, the temperature sensor on A1 at room
+ *        temperature (10 mV / degree C)
+ */
+static void adc_model_reset(void) {
+    memset(adc_mv, 0, sizeof(adc_mv));
+    adc_mv[0] = ADC_VREF_MV / 2;
+    adc_mv[1] = 250;
+    converting = 0;
+}
+
+static void adc_model_step(uint64_t now_ns) {
+    if (!converting || now_ns < done_ns) {
+        return;
+    }
+    converting = 0;
+    int chan = adc_channel();
+    uint32_t full = (1UL << adc_bits()) - 1;
+    uint32_t mv = (chan < ADC_CHANNELS) ? adc_mv[chan] : 0;
+    SIM_REG(ADC1_DR) = (mv * full + ADC_VREF_MV / 2) / ADC_VREF_MV;
+    SIM_SET_BITS(ADC1_SR, ADC_SR_EOC);
+    if (SIM_REG(ADC1_CR1) & ADC_CR1_EOCIE) {
+        sim_irq_raise(ADC_IRQ);
+    }
+}
+
+/**
+ * @brief SWSTART in CR2 starts a conversion if the ADC is on; a DR read
+ *        clears EOC
+ */
+static void adc_model_access(uintptr_t addr, int write, uint64_t now_ns) {
+    if (write && addr == ADC1_CR2) {
+        uint32_t cr2 = SIM_REG(ADC1_CR2);
+        if (!(cr2 & ADC_CR2_SWSTART)) {
+            return;
+        }
+        SIM_CLR_BITS(ADC1_CR2, ADC_CR2_SWSTART);
+        if (!(cr2 & ADC_CR2_ADON)) {
+            return;
+        }
+        SIM_CLR_BITS(ADC1_SR, ADC_SR_EOC);
+        SIM_SET_BITS(ADC1_SR, ADC_SR_STRT);
+        converting = 1;
+        done_ns = now_ns + adc_conversion_ns(adc_channel());
+    } else if (!write && addr == ADC1_DR) {
+        SIM_CLR_BITS(ADC1_SR, ADC_SR_EOC);
+    }
+}
+
+const sim_model_t sim_adc_model = {
+    .name = "adc1",
+    .reset = adc_model_reset,
+    .step = adc_model_step,
+    .access = adc_model_access,
+};
@@ -0,0 +1,369 @@
+/**
+ * @file   sim_core.c
+ *
+ * @brief  Host build: NVIC, interrupt delivery and the DWT cycle counter
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <arm.h>
+#include <sim.h>
+
+/*
+ * An interrupt is SIGUSR2 sent to the process. Only the thread of the running
+ * task has signals unblocked, and taskENTER_CRITICAL blocks them, so the
+ * kernel delivers it exactly where the Cortex-M would take the exception.
+ * The handler runs the pending vectors by NVIC priority with every signal
+ * blocked, like the SIGALRM tick of the POSIX port.
+ */
+#define SIM_IRQ_SIGNAL  SIGUSR2
+
+#define NVIC_ISER       (0xE000E100)
+#define NVIC_ICER       (0xE000E180)
+#define NVIC_ISPR       (0xE000E200)
+#define NVIC_ICPR       (0xE000E280)
+#define NVIC_IPR        (0xE000E400)
+#define NVIC_WORDS      (SIM_IRQ_COUNT / 32)
+
+#define SCB_VTOR        (0xE000ED08)
+/** @brief system exceptions ahead of IRQ0 in a vector table */
+#define VECTOR_IRQ0     (16)
+
+#define DWT_CTRL        (0xE0001000)
+#define DWT_CTRL_CYCCNTENA (1 << 0)
+#define DWT_CYCCNT      (0xE0001004)
+
+/** @brief the local exclusive monitor of each thread, see arm.h */
+__thread struct arm_monitor arm_monitor;
+/** @brief IPSR, see arm.h */
+volatile uint32_t arm_ipsr;
+/** @brief the exception frame, see arm.h */
+volatile uint32_t arm_frame[8];
+
+/*
+ * Vector table, IRQ number -> handler, mirroring asm/boot.S. Weak, so a
+ * project without one of these drivers still links; its IRQ then stops the
+ * simulation like the "spin" vector would hang the board.
+ */
+#define SIM_VECTOR(name) extern void name(void) __attribute__((weak))
+SIM_VECTOR(EXTI0_IRQHandler);
+SIM_VECTOR(EXTI1_IRQHandler);
+SIM_VECTOR(EXTI4_IRQHandler);
+SIM_VECTOR(uart_rx_dma_irq_handler);
+SIM_VECTOR(uart_tx_dma_irq_handler);
+SIM_VECTOR(EXTI9_5_IRQHandler);
+SIM_VECTOR(tim1_up_irq_handler);
+SIM_VECTOR(tim2_irq_handler);
+SIM_VECTOR(tim3_irq_handler);
+SIM_VECTOR(tim4_irq_handler);
+SIM_VECTOR(uart_irq_handler);
+SIM_VECTOR(EXTI15_10_IRQHandler);
+SIM_VECTOR(tim5_irq_handler);
+
+static void (*const sim_vectors[SIM_IRQ_COUNT])(void) = {
+    [6] = EXTI0_IRQHandler,
+    [7] = EXTI1_IRQHandler,
+    [10] = EXTI4_IRQHandler,
+    [16] = uart_rx_dma_irq_handler,
+    [17] = uart_tx_dma_irq_handler,
+    [23] = EXTI9_5_IRQHandler,
+    [25] = tim1_up_irq_handler,
+    [28] = tim2_irq_handler,
+    [29] = tim3_irq_handler,
+    [30] = tim4_irq_handler,
+    [38] = uart_irq_handler,
+    [40] = EXTI15_10_IRQHandler,
+    [50] = tim5_irq_handler,
+};
+
+/*
+ * The same table as the board's flash holds it, 32-bit words, which VTOR
+ * points at after reset. The firmware may copy it and move VTOR, so vectors
+ * are always fetched through VTOR. A non-PIE host binary keeps code and data
+ * under 4 GB, where a word holds their addresses.
+ */
+static uint32_t sim_ivt[VECTOR_IRQ0 + SIM_IRQ_COUNT];
+
+/** @brief NVIC state; ISER/ICER and ISPR/ICPR read back as these */
+static uint32_t nvic_enabled[NVIC_WORDS];
+static uint32_t nvic_pending[NVIC_WORDS];
+
+/** @brief cycles already counted into DWT_CYCCNT, in ns of host time */
+static uint64_t dwt_last_ns;
+/** @brief host time the firmware last wrote DWT_CYCCNT */
+static uint64_t dwt_epoch_ns;
+
+/** @brief time spent in each vector, for the SIM_STATS report */
+static struct {
+    uint32_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} isr_stats[SIM_IRQ_COUNT];
+
+/** @brief non-zero while the signal handler is running vectors */
+static volatile sig_atomic_t sim_in_isr;
+/** @brief a vector asked for a context switch on its way out */
+static volatile sig_atomic_t sim_yield_pending;
+
+void __real_vPortYield(void);
+
+/**
+ * @brief portYIELD_FROM_ISR on the POSIX port switches threads on the spot,
+ *        in the middle of the handler. Hold it until the last vector has
+ *        returned instead, which is what PendSV does on the board.
+ */
+void __wrap_vPortYield(void) {
+    if (sim_in_isr) {
+        sim_yield_pending = 1;
+        return;
+    }
+    __real_vPortYield();
+}
+
+/**
+ * @brief mirror the NVIC state into the registers and signal the CPU if
+ *        anything is ready to run. Caller holds the model lock.
+ */
+static void nvic_update(void) {
+    int ready = 0;
+    for (int i = 0; i < NVIC_WORDS; i++) {
+        SIM_REG(NVIC_ISER + 4 * i) = nvic_enabled[i];
+        SIM_REG(NVIC_ICER + 4 * i) = nvic_enabled[i];
+        SIM_REG(NVIC_ISPR + 4 * i) = nvic_pending[i];
+        SIM_REG(NVIC_ICPR + 4 * i) = nvic_pending[i];
+        ready |= (nvic_enabled[i] & nvic_pending[i]) != 0;
+    }
+    if (ready) {
+        kill(getpid(), SIM_IRQ_SIGNAL);
+    }
+}
+
+/**
+ * @brief mark irq pending. Caller holds the model lock.
+ */
+void sim_irq_raise(int irq) {
+    if (irq < 0 || irq >= SIM_IRQ_COUNT) {
+        return;
+    }
+    nvic_pending[irq / 32] |= 1UL << (irq % 32);
+    nvic_update();
+}
+
+/**
+ * @brief pick the enabled pending IRQ with the best priority (lowest IPR
+ *        value, then lowest number), and clear its pending bit as exception
+ *        entry does. Returns -1 if there is none.
+ */
+static int nvic_take(void) {
+    sigset_t saved;
+    int best = -1;
+    uint8_t best_prio = 0xFF;
+
+    sim_lock(&saved);
+    for (int irq = 0; irq < SIM_IRQ_COUNT; irq++) {
+        uint32_t bit = 1UL << (irq % 32);
+        if ((nvic_enabled[irq / 32] & nvic_pending[irq / 32] & bit) == 0) {
+            continue;
+        }
+        uint8_t prio = *(volatile uint8_t *)(uintptr_t)(NVIC_IPR + irq);
+        if (best < 0 || prio < best_prio) {
+            best = irq;
+            best_prio = prio;
+        }
+    }
+    if (best >= 0) {
+        nvic_pending[best / 32] &= ~(1UL << (best % 32));
+        for (int i = 0; i < NVIC_WORDS; i++) {
+            SIM_REG(NVIC_ISPR + 4 * i) = nvic_pending[i];
+            SIM_REG(NVIC_ICPR + 4 * i) = nvic_pending[i];
+        }
+    }
+    sim_unlock(&saved);
+    return best;
+}
+
+/**
+ * @brief where the signal stopped the task, as the PC of its exception frame
+ */
+static uint32_t sim_interrupted_pc(const ucontext_t *uc) {
+#if defined(__x86_64__)
+    return (uint32_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+    return (uint32_t)uc->uc_mcontext.pc;
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
+/**
+ * @brief the interrupt signal: run every pending vector, then do the context
+ *        switch they asked for
+ */
+static void sim_irq_signal(int sig, siginfo_t *info, void *context) {
+    (void)sig;
+    (void)info;
+    int irq;
+
+    sim_in_isr = 1;
+    arm_frame[6] = sim_interrupted_pc((const ucontext_t *)context);
+    while ((irq = nvic_take()) >= 0) {
+        const volatile uint32_t *ivt = (const volatile uint32_t *)(uintptr_t)SIM_REG(SCB_VTOR);
+        void (*vector)(void) = (void (*)(void))(uintptr_t)ivt[VECTOR_IRQ0 + irq];
+        if (vector == NULL) {
+            sim_fatal("IRQ%d is enabled but has no handler", irq);
+        }
+        uint64_t start = sim_now_ns();
+        arm_ipsr = VECTOR_IRQ0 + irq;
+        vector();
+        arm_ipsr = 0;
+        // exception return clears the exclusive monitor
+        clrex();
+        uint64_t spent = sim_now_ns() - start;
+        isr_stats[irq].count++;
+        isr_stats[irq].total_ns += spent;
+        if (spent > isr_stats[irq].max_ns) {
+            isr_stats[irq].max_ns = spent;
+        }
+    }
+    sim_in_isr = 0;
+
+    if (sim_yield_pending) {
+        sim_yield_pending = 0;
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+            __real_vPortYield();
+        }
+    }
+}
+
+/**
+ * @brief install the interrupt signal handler
+ */
+void sim_irq_init(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sim_irq_signal;
+    sa.sa_flags = SA_SIGINFO;
+    sigfillset(&sa.sa_mask);
+    if (sigaction(SIM_IRQ_SIGNAL, &sa, NULL) != 0) {
+        sim_fatal("cannot install the interrupt handler");
+    }
+}
+
+/**
+ * @brief power-on: everything disabled, nothing pending
+ */
+static void core_reset(void) {
+    memset(nvic_enabled, 0, sizeof(nvic_enabled));
+    memset(nvic_pending, 0, sizeof(nvic_pending));
+    memset(isr_stats, 0, sizeof(isr_stats));
+    for (int irq = 0; irq < SIM_IRQ_COUNT; irq++) {
+        uintptr_t vector = (uintptr_t)sim_vectors[irq];
+        if (vector > UINT32_MAX) {
+            sim_fatal("IRQ%d handler is above 4 GB, link the host build with -no-pie", irq);
+        }
+        sim_ivt[VECTOR_IRQ0 + irq] = (uint32_t)vector;
+    }
+    SIM_REG(SCB_VTOR) = (uint32_t)(uintptr_t)sim_ivt;
+    dwt_last_ns = 0;
+    dwt_epoch_ns = 0;
+}
+
+/**
+ * @brief DWT_CYCCNT counts SIM_CPU_HZ while enabled; the firmware may also
+ *        write it, so it is advanced rather than recomputed
+ */
+static void core_step(uint64_t now_ns) {
+    uint64_t cycles = (now_ns - dwt_last_ns) * (SIM_CPU_HZ / 1000000) / 1000;
+    if (cycles == 0) {
+        return;
+    }
+    dwt_last_ns += cycles * 1000 / (SIM_CPU_HZ / 1000000);
+    if (SIM_REG(DWT_CTRL) & DWT_CTRL_CYCCNTENA) {
+        SIM_REG(DWT_CYCCNT) += (uint32_t)cycles;
+    }
+}
+
+/**
+ * @brief ISER / ICER set and clear enables, ICPR clears pending; all three
+ *        are write-1 and the written word is still in the register. A
+ *        CYCCNT read brings the counter up to now first; a write restarts
+ *        the count from the written value.
+ */
+static void core_access(uintptr_t addr, int write, uint64_t now_ns) {
+    if (addr == DWT_CYCCNT) {
+        if (write) {
+            dwt_last_ns = dwt_epoch_ns = now_ns;
+        } else {
+            core_step(now_ns);
+        }
+        return;
+    }
+    if (!write || addr < NVIC_ISER || addr >= NVIC_ICPR + 4 * NVIC_WORDS) {
+        return;
+    }
+    int word = (addr & 0x7F) / 4;
+    uint32_t bits = SIM_REG(addr);
+
+    if (word >= NVIC_WORDS) {
+        return;
+    }
+    switch (addr & ~0x7FUL) {
+    case NVIC_ISER:
+        nvic_enabled[word] |= bits;
+        break;
+    case NVIC_ICER:
+        nvic_enabled[word] &= ~bits;
+        break;
+    case NVIC_ISPR:
+        nvic_pending[word] |= bits;
+        break;
+    case NVIC_ICPR:
+        nvic_pending[word] &= ~bits;
+        break;
+    default:
+        return;
+    }
+    nvic_update();
+}
+
+uint64_t sim_dwt_epoch_ns(void) {
+    return dwt_epoch_ns;
+}
+
+/**
+ * @brief interrupt load per IRQ, in host time: the absolute numbers depend
+ *        on the host, the shares between IRQs and over runs are what to watch
+ */
+static void core_stop(uint64_t now_ns) {
+    if (!sim_stats_enabled() || now_ns == 0) {
+        return;
+    }
+    fprintf(stderr, "\r\nsim: irq   count      total us   max us   load %%\r\n");
+    for (int irq = 0; irq < SIM_IRQ_COUNT; irq++) {
+        if (isr_stats[irq].count == 0) {
+            continue;
+        }
+        fprintf(stderr, "sim: %3d %8lu %12llu %8llu %8.3f\r\n", irq, (unsigned long)isr_stats[irq].count,
+                (unsigned long long)(isr_stats[irq].total_ns / 1000), (unsigned long long)(isr_stats[irq].max_ns / 1000),
+                100.0 * isr_stats[irq].total_ns / now_ns);
+    }
+}
+
+const sim_model_t sim_core_model = {
+    .name = "core",
+    .reset = core_reset,
+    .step = core_step,
+    .access = core_access,
+    .stop = core_stop,
+};
@@ -0,0 +1,226 @@
+/**
+ * @file   sim_gpio.c
+ *
+ * @brief  Host build: GPIOA-C pins and the EXTI edge detector
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <string.h>
+#include <sim.h>
+
+/*
+ * IDR is worked out from the pin configuration: an output reads back its
+ * ODR, an input reads what the outside world drives (sim_gpio_drive) or
+ * else its pull, an analog pin reads 0. BSRR acts on ODR when the driver
+ * marks the write. An external level change is an edge for EXTI: it goes
+ * through the SYSCFG port selection and the trigger registers into PR and,
+ * if unmasked, to the NVIC, and to the timer inputs on the pin.
+ */
+
+#define GPIO_PORTS      (3)
+#define GPIO_BASE(p)    (0x40020000UL + 0x400UL * (p))
+#define GPIO_MODER(p)   (GPIO_BASE(p) + 0x00)
+#define GPIO_PUPDR(p)   (GPIO_BASE(p) + 0x0C)
+#define GPIO_IDR(p)     (GPIO_BASE(p) + 0x10)
+#define GPIO_ODR(p)     (GPIO_BASE(p) + 0x14)
+#define GPIO_BSRR(p)    (GPIO_BASE(p) + 0x18)
+#define GPIO_MODE_OUTPUT    (0x1)
+#define GPIO_MODE_ALT       (0x2)
+#define GPIO_MODE_ANALOG    (0x3)
+#define GPIO_PULL_UP        (0x1)
+
+#define SYSCFG_EXTICR(n) (0x40013808 + 4 * (n))
+#define EXTI_IMR        (0x40013C00)
+#define EXTI_RTSR       (0x40013C08)
+#define EXTI_FTSR       (0x40013C0C)
+#define EXTI_SWIER      (0x40013C10)
+#define EXTI_PR         (0x40013C14)
+#define EXTI_LINES      (16)
+
+/** @brief pins the outside world drives, and the levels it drives them to */
+static uint16_t ext_driven[GPIO_PORTS];
+static uint16_t ext_level[GPIO_PORTS];
+
+/** @brief EXTI pending lines; PR reads back as this */
+static uint32_t exti_pending;
+
+/**
+ * @brief NVIC line of an EXTI line: 0-4 have their own, 5-9 and 10-15 share
+ */
+static int exti_irq(int line) {
+    if (line <= 4) {
+        return 6 + line;
+    }
+    return (line <= 9) ? 23 : 40;
+}
+
+/**
+ * @brief what the pins of port read as right now
+ */
+static uint32_t gpio_idr(int port) {
+    uint32_t moder = SIM_REG(GPIO_MODER(port));
+    uint32_t pupdr = SIM_REG(GPIO_PUPDR(port));
+    uint32_t odr = SIM_REG(GPIO_ODR(port));
+    uint32_t idr = 0;
+
+    for (int pin = 0; pin < 16; pin++) {
+        uint32_t mode = (moder >> (2 * pin)) & 0x3;
+        uint32_t bit = 1UL << pin;
+        int level;
+        if (mode == GPIO_MODE_OUTPUT) {
+            level = (odr & bit) != 0;
+        } else if (mode == GPIO_MODE_ANALOG) {
+            level = 0;
+        } else if (ext_driven[port] & bit) {
+            level = (ext_level[port] & bit) != 0;
+        } else if (mode == GPIO_MODE_ALT) {
+            // nothing outside: an alternate function output idles high
+            level = 1;
+        } else {
+            level = ((pupdr >> (2 * pin)) & 0x3) == GPIO_PULL_UP;
+        }
+        idr |= (uint32_t)level << pin;
+    }
+    return idr;
+}
+
+/**
+ * @brief mirror the pending lines into PR and request the shared vectors of
+ *        those that are unmasked; PR stays set until the handler clears it
+ */
+static void exti_update(void) {
+    uint32_t active = exti_pending & SIM_REG(EXTI_IMR);
+    SIM_REG(EXTI_PR) = exti_pending;
+    SIM_REG(EXTI_SWIER) &= exti_pending;
+    for (int line = 0; line < EXTI_LINES; line++) {
+        if (active & (1UL << line)) {
+            sim_irq_raise(exti_irq(line));
+        }
+    }
+}
+
+/**
+ * @brief a level change on port/pin, as seen by the edge detector of its line
+ */
+static void exti_edge(int port, int pin, int rising) {
+    uint32_t bit = 1UL << pin;
+    uint32_t source = (SIM_REG(SYSCFG_EXTICR(pin / 4)) >> (4 * (pin % 4))) & 0xF;
+    uint32_t trigger = SIM_REG(rising ? EXTI_RTSR : EXTI_FTSR);
+
+    if (source != (uint32_t)port || !(trigger & bit)) {
+        return;
+    }
+    exti_pending |= bit;
+    exti_update();
+}
+
+/**
+ * @brief recompute IDR of port after something about it changed
+ */
+static void gpio_refresh(int port) {
+    SIM_REG(GPIO_IDR(port)) = gpio_idr(port);
+}
+
+void sim_gpio_drive(int port, int pin, int level) {
+    if (port < 0 || port >= GPIO_PORTS || pin < 0 || pin >= 16) {
+        return;
+    }
+    uint32_t bit = 1UL << pin;
+    uint32_t before = SIM_REG(GPIO_IDR(port)) & bit;
+
+    ext_driven[port] |= bit;
+    if (level) {
+        ext_level[port] |= bit;
+    } else {
+        ext_level[port] &= ~bit;
+    }
+    gpio_refresh(port);
+
+    uint32_t after = SIM_REG(GPIO_IDR(port)) & bit;
+    if (before != after) {
+        exti_edge(port, pin, after != 0);
+        sim_tim_input(port, pin);
+    }
+}
+
+void sim_gpio_release(int port, int pin) {
+    if (port < 0 || port >= GPIO_PORTS || pin < 0 || pin >= 16) {
+        return;
+    }
+    uint32_t bit = 1UL << pin;
+    uint32_t before = SIM_REG(GPIO_IDR(port)) & bit;
+
+    ext_driven[port] &= ~bit;
+    gpio_refresh(port);
+
+    uint32_t after = SIM_REG(GPIO_IDR(port)) & bit;
+    if (before != after) {
+        exti_edge(port, pin, after != 0);
+        sim_tim_input(port, pin);
+    }
+}
+
+int sim_gpio_output(int port, int pin) {
+    if (port < 0 || port >= GPIO_PORTS || pin < 0 || pin >= 16) {
+        return 0;
+    }
+    return (SIM_REG(GPIO_ODR(port)) >> pin) & 1;
+}
+
+static void gpio_model_reset(void) {
+    memset(ext_driven, 0, sizeof(ext_driven));
+    memset(ext_level, 0, sizeof(ext_level));
+    exti_pending = 0;
+    for (int port = 0; port < GPIO_PORTS; port++) {
+        gpio_refresh(port);
+    }
+}
+
+/**
+ * @brief gpio_init writes MODER / PUPDR without a marker, pick those up
+ */
+static void gpio_model_step(uint64_t now_ns) {
+    (void)now_ns;
+    for (int port = 0; port < GPIO_PORTS; port++) {
+        gpio_refresh(port);
+    }
+}
+
+/**
+ * @brief BSRR sets and resets ODR bits and reads back 0; PR is write-1 to
+ *        clear; a 1 in SWIER raises an unmasked line as an edge would
+ */
+static void gpio_model_access(uintptr_t addr, int write, uint64_t now_ns) {
+    (void)now_ns;
+    if (!write) {
+        return;
+    }
+    for (int port = 0; port < GPIO_PORTS; port++) {
+        if (addr == GPIO_BSRR(port)) {
+            uint32_t bsrr = SIM_REG(addr);
+            uint32_t odr = SIM_REG(GPIO_ODR(port));
+            // set wins when both halves name the same pin
+            SIM_REG(GPIO_ODR(port)) = (odr & ~(bsrr >> 16)) | (bsrr & 0xFFFF);
+            SIM_REG(addr) = 0;
+            gpio_refresh(port);
+            return;
+        }
+    }
+    if (addr == EXTI_PR) {
+        exti_pending &= ~SIM_REG(EXTI_PR);
+        exti_update();
+    } else if (addr == EXTI_SWIER) {
+        exti_pending |= SIM_REG(EXTI_SWIER) & SIM_REG(EXTI_IMR) & ((1UL << EXTI_LINES) - 1);
+        exti_update();
+    }
+}
+
+const sim_model_t sim_gpio_model = {
+    .name = "gpio",
+    .reset = gpio_model_reset,
+    .step = gpio_model_step,
+    .access = gpio_model_access,
+};
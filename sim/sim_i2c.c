@@ -0,0 +1,173 @@
+/**
+ * @file   sim_i2c.c
+ *
+ * @brief  Host build: I2C1 in master transmitter mode, with every slave acking
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sim.h>
+
+/*
+ * The master sequence of the reference manual, at the SCL rate CCR sets:
+ * START -> SB, address in DR -> ADDR nine bit times later, SR1-then-SR2
+ * read clears ADDR, each data byte in DR clears TXE / BTF for nine bit
+ * times, STOP frees the bus. Whoever is at the address always acks and
+ * takes the bytes; they are only counted.
+ */
+
+#define I2C1_CR1        (0x40005400)
+#define I2C1_DR         (0x40005410)
+#define I2C1_SR1        (0x40005414)
+#define I2C1_SR2        (0x40005418)
+#define I2C1_CCR        (0x4000541C)
+#define I2C_CR1_PE      (1 << 0)
+#define I2C_CR1_START   (1 << 8)
+#define I2C_CR1_STOP    (1 << 9)
+#define I2C_SR1_SB      (1 << 0)
+#define I2C_SR1_ADDR    (1 << 1)
+#define I2C_SR1_BTF     (1 << 2)
+#define I2C_SR1_TXE     (1 << 7)
+#define I2C_SR2_MSL     (1 << 0)
+#define I2C_SR2_BUSY    (1 << 1)
+#define I2C_SR2_TRA     (1 << 2)
+
+/** @brief where the master is in a transfer */
+typedef enum {
+    I2C_IDLE,       /**< bus free */
+    I2C_START,      /**< START condition going out */
+    I2C_SB,         /**< START done, waiting for the address in DR */
+    I2C_ADDRESS,    /**< address byte going out */
+    I2C_ADDR,       /**< acked, waiting for the SR2 read */
+    I2C_DATA,       /**< data byte going out, or waiting for the next one */
+    I2C_STOP,       /**< STOP condition going out */
+} i2c_phase_t;
+
+static i2c_phase_t phase;
+/** @brief host time the bit in flight is done */
+static uint64_t due_ns;
+/** @brief a data byte is in the shift register */
+static int shifting;
+
+/** @brief traffic, for the SIM_STATS report */
+static uint32_t transfers;
+static uint32_t bytes;
+
+/**
+ * @brief one SCL period in ns: standard mode, SCL high and low are CCR
+ *        APB1 clocks each
+ */
+static uint64_t i2c_bit_ns(void) {
+    uint32_t ccr = SIM_REG(I2C1_CCR) & 0xFFF;
+    if (ccr == 0) {
+        ccr = 80;
+    }
+    return 2ULL * ccr * 1000000000ULL / SIM_CPU_HZ;
+}
+
+static void i2c_model_reset(void) {
+    phase = I2C_IDLE;
+    due_ns = 0;
+    shifting = 0;
+    transfers = 0;
+    bytes = 0;
+}
+
+/**
+ * @brief finish whatever was in flight once its bit times have passed
+ */
+static void i2c_model_step(uint64_t now_ns) {
+    if (now_ns < due_ns) {
+        return;
+    }
+    switch (phase) {
+    case I2C_START:
+        SIM_CLR_BITS(I2C1_CR1, I2C_CR1_START);
+        SIM_SET_BITS(I2C1_SR1, I2C_SR1_SB);
+        SIM_REG(I2C1_SR2) = I2C_SR2_MSL | I2C_SR2_BUSY;
+        phase = I2C_SB;
+        break;
+    case I2C_ADDRESS:
+        SIM_SET_BITS(I2C1_SR1, I2C_SR1_ADDR);
+        phase = I2C_ADDR;
+        break;
+    case I2C_DATA:
+        if (shifting) {
+            shifting = 0;
+            bytes++;
+            SIM_SET_BITS(I2C1_SR1, I2C_SR1_TXE | I2C_SR1_BTF);
+        }
+        break;
+    case I2C_STOP:
+        SIM_CLR_BITS(I2C1_CR1, I2C_CR1_STOP);
+        SIM_REG(I2C1_SR1) = 0;
+        SIM_REG(I2C1_SR2) = 0;
+        phase = I2C_IDLE;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief START / STOP in CR1, DR writes and the SR2 read move the sequence on
+ */
+static void i2c_model_access(uintptr_t addr, int write, uint64_t now_ns) {
+    if (!(SIM_REG(I2C1_CR1) & I2C_CR1_PE)) {
+        return;
+    }
+    if (write && addr == I2C1_CR1) {
+        uint32_t cr1 = SIM_REG(I2C1_CR1);
+        if ((cr1 & I2C_CR1_START) && (phase == I2C_IDLE || phase == I2C_DATA)) {
+            // a repeated start waits for the byte in flight
+            phase = I2C_START;
+            due_ns = (shifting ? due_ns : now_ns) + i2c_bit_ns();
+            shifting = 0;
+        } else if ((cr1 & I2C_CR1_STOP) && phase != I2C_IDLE && phase != I2C_STOP) {
+            if (shifting) {
+                bytes++;
+            }
+            phase = I2C_STOP;
+            due_ns = (shifting ? due_ns : now_ns) + i2c_bit_ns();
+            shifting = 0;
+        }
+    } else if (write && addr == I2C1_DR) {
+        if (phase == I2C_SB) {
+            SIM_CLR_BITS(I2C1_SR1, I2C_SR1_SB);
+            SIM_REG(I2C1_SR2) |= (SIM_REG(I2C1_DR) & 1) ? 0 : I2C_SR2_TRA;
+            phase = I2C_ADDRESS;
+            due_ns = now_ns + 9 * i2c_bit_ns();
+            transfers++;
+        } else if (phase == I2C_DATA) {
+            SIM_CLR_BITS(I2C1_SR1, I2C_SR1_TXE | I2C_SR1_BTF);
+            due_ns = (shifting ? due_ns : now_ns) + 9 * i2c_bit_ns();
+            if (shifting) {
+                bytes++;
+            }
+            shifting = 1;
+        }
+    } else if (!write && addr == I2C1_SR2 && phase == I2C_ADDR) {
+        SIM_CLR_BITS(I2C1_SR1, I2C_SR1_ADDR);
+        SIM_SET_BITS(I2C1_SR1, I2C_SR1_TXE);
+        phase = I2C_DATA;
+    }
+}
+
+static void i2c_model_stop(uint64_t now_ns) {
+    (void)now_ns;
+    if (sim_stats_enabled()) {
+        fprintf(stderr, "sim: i2c1 %lu transfers, %lu data bytes\r\n", (unsigned long)transfers, (unsigned long)bytes);
+    }
+}
+
+const sim_model_t sim_i2c_model = {
+    .name = "i2c1",
+    .reset = i2c_model_reset,
+    .step = i2c_model_step,
+    .access = i2c_model_access,
+    .stop = i2c_model_stop,
+};
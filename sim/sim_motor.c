@@ -0,0 +1,230 @@
+/**
+ * @file   sim_motor.c
+ *
+ * @brief  Host build: the DC gearmotor, its H-bridge and the quadrature encoder
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sim.h>
+#include <gpio_pin_yuhong.h>
+
+/*
+ * The plant wired as on Yuhong's board: IN1 / IN2 on the H-bridge inputs,
+ * the enable pin on the PWM output of TIM3 CH1, the encoder on ENC_A / ENC_B.
+ *
+ * The bridge behaves like an L298: enable high with IN1 != IN2 drives the
+ * supply across the motor, IN1 == IN2 brakes, enable low lets it coast.
+ * PWM is taken as its average, duty = CCR1 / (ARR + 1). Winding inductance
+ * is neglected (its time constant is far below the 100 us step), so
+ *
+ *     i = (v - Ke w) / R,   J dw/dt = Kt i - b w - Tc sgn(w)
+ *
+ * and the shaft sticks while the motor torque stays under Coulomb friction.
+ * The encoder counts ENCODER_TICKS per output revolution after quadrature;
+ * forward drive counts up, which is the sense findBestPath assumes.
+ *
+ * Edges go out one per hardware step at most (10 kHz): two edges in one
+ * step would reach the firmware as one EXTI interrupt, a loss the real
+ * encoder would not cause. Top speed stays under that rate; the report
+ * shows how far the pins ever fell behind the shaft. A SIM_REPLAY trace
+ * with encoder events takes the pins over (sim_replay.c).
+ */
+
+/** @brief supply across the bridge, V */
+#define MOTOR_SUPPLY_V      (12.0)
+/** @brief winding resistance, ohm */
+#define MOTOR_R_OHM         (3.0)
+/** @brief torque and back-EMF constant, N m / A = V s / rad */
+#define MOTOR_K             (0.012)
+/** @brief rotor plus reflected load inertia, kg m^2 */
+#define MOTOR_J             (2.0e-6)
+/** @brief viscous friction, N m s / rad */
+#define MOTOR_B             (2.0e-7)
+/** @brief Coulomb friction, N m; about 12.5 % duty to break away */
+#define MOTOR_TC            (6.0e-3)
+/** @brief gearbox reduction */
+#define MOTOR_GEAR          (30.0)
+/** @brief encoder counts per output revolution */
+#define ENCODER_TICKS       (1200)
+/** @brief integration step, s */
+#define MOTOR_DT            (10e-6)
+/** @brief speed below which the shaft counts as stopped, rad/s (motor side) */
+#define MOTOR_W_STOP        (1e-3)
+
+#define PI                  (3.14159265358979323846)
+
+#define TIM3_CR1            (0x40000400)
+#define TIM3_CCER           (0x40000420)
+#define TIM3_ARR            (0x4000042C)
+#define TIM3_CCR1           (0x40000434)
+#define TIM_CR1_CEN         (1 << 0)
+#define TIM_CCER_CC1E       (1 << 0)
+#define RCC_APB1ENR         (0x40023840)
+#define RCC_TIM3EN          (1 << 1)
+
+/** @brief motor speed, rad/s, and output angle in encoder counts */
+static double w;
+static double counts;
+/** @brief count the encoder pins show */
+static long enc_count;
+/** @brief host time integrated up to */
+static uint64_t last_ns;
+
+/** @brief SIM_MOTOR_TRACE: one CSV line per ms */
+static FILE *trace;
+static uint64_t trace_next_ns;
+
+/** @brief for the SIM_STATS report */
+static double w_peak;
+static long backlog_peak;
+static uint32_t edges;
+
+/**
+ * @brief PWM duty on the enable pin, 0..1
+ */
+static double motor_duty(void) {
+    if (!(SIM_REG(RCC_APB1ENR) & RCC_TIM3EN) || !(SIM_REG(TIM3_CR1) & TIM_CR1_CEN)
+        || !(SIM_REG(TIM3_CCER) & TIM_CCER_CC1E)) {
+        return 0.0;
+    }
+    double period = (double)(SIM_REG(TIM3_ARR) & 0xFFFF) + 1.0;
+    double duty = (SIM_REG(TIM3_CCR1) & 0xFFFF) / period;
+    return (duty > 1.0) ? 1.0 : duty;
+}
+
+/**
+ * @brief average motor torque over a PWM period at speed w_now
+ */
+static double motor_torque(double duty, double w_now) {
+    int in1 = sim_gpio_output(MORTO_IN1_PORT, MORTO_IN1_PIN);
+    int in2 = sim_gpio_output(MORTO_IN2_PORT, MORTO_IN2_PIN);
+    double v;
+
+    if (in1 == in2) {
+        v = 0.0; // brake: the bridge shorts the winding
+    } else {
+        v = in1 ? MOTOR_SUPPLY_V : -MOTOR_SUPPLY_V;
+    }
+    // while the enable pin is low the winding is open and carries nothing
+    return duty * MOTOR_K * (v - MOTOR_K * w_now) / MOTOR_R_OHM;
+}
+
+/**
+ * @brief one MOTOR_DT of the mechanics
+ */
+static void motor_integrate(double duty) {
+    double torque = motor_torque(duty, w);
+
+    if (w > -MOTOR_W_STOP && w < MOTOR_W_STOP) {
+        if (torque > -MOTOR_TC && torque < MOTOR_TC) {
+            w = 0.0; // static friction holds the shaft
+            return;
+        }
+        torque -= (torque > 0) ? MOTOR_TC : -MOTOR_TC;
+    } else {
+        torque -= (w > 0) ? MOTOR_TC : -MOTOR_TC;
+    }
+    double w_next = w + (torque - MOTOR_B * w) / MOTOR_J * MOTOR_DT;
+    // friction stops the shaft, it does not turn it around
+    if ((w > 0 && w_next < 0) || (w < 0 && w_next > 0)) {
+        w_next = 0.0;
+    }
+    w = w_next;
+    counts += w / MOTOR_GEAR / (2 * PI) * ENCODER_TICKS * MOTOR_DT;
+
+    double w_abs = (w < 0) ? -w : w;
+    if (w_abs > w_peak) {
+        w_peak = w_abs;
+    }
+}
+
+/**
+ * @brief put the quadrature state of count on the pins: forward goes
+ *        AB = 00, 01, 11, 10
+ */
+static void encoder_output(long count) {
+    static const uint8_t gray[4] = {0x0, 0x1, 0x3, 0x2};
+    if (sim_replay_encoder()) {
+        return;
+    }
+    uint8_t ab = gray[((count % 4) + 4) % 4];
+    sim_gpio_drive(ENC_A_PORT, ENC_A_PIN, (ab >> 1) & 1);
+    sim_gpio_drive(ENC_B_PORT, ENC_B_PIN, ab & 1);
+}
+
+static void motor_model_reset(void) {
+    w = 0.0;
+    counts = 0.0;
+    enc_count = 0;
+    last_ns = 0;
+    w_peak = 0.0;
+    backlog_peak = 0;
+    edges = 0;
+    encoder_output(0);
+
+    const char *path = getenv("SIM_MOTOR_TRACE");
+    trace = NULL;
+    trace_next_ns = 0;
+    if (path != NULL && path[0] != '\0') {
+        trace = fopen(path, "w");
+        if (trace == NULL) {
+            sim_fatal("cannot open SIM_MOTOR_TRACE file %s", path);
+        }
+        fprintf(trace, "t_ms,duty,in1,in2,rpm,counts,encoder\n");
+    }
+}
+
+static void motor_model_step(uint64_t now_ns) {
+    double duty = motor_duty();
+    // a host hiccup is not worth more than 10 ms of plant time
+    uint64_t span = now_ns - last_ns;
+    if (span > 10000000) {
+        last_ns = now_ns - 10000000;
+    }
+    while (last_ns + (uint64_t)(MOTOR_DT * 1e9) <= now_ns) {
+        motor_integrate(duty);
+        last_ns += (uint64_t)(MOTOR_DT * 1e9);
+    }
+
+    long target = (long)counts - (counts < 0 && counts != (long)counts);
+    long backlog = (target > enc_count) ? target - enc_count : enc_count - target;
+    if (backlog > backlog_peak) {
+        backlog_peak = backlog;
+    }
+    if (target != enc_count) {
+        enc_count += (target > enc_count) ? 1 : -1;
+        encoder_output(enc_count);
+        edges++;
+    }
+
+    if (trace != NULL && now_ns >= trace_next_ns) {
+        trace_next_ns = now_ns + 1000000;
+        fprintf(trace, "%.3f,%.4f,%d,%d,%.1f,%.2f,%ld\n", now_ns / 1e6, duty,
+                sim_gpio_output(MORTO_IN1_PORT, MORTO_IN1_PIN), sim_gpio_output(MORTO_IN2_PORT, MORTO_IN2_PIN),
+                w / MOTOR_GEAR * 60 / (2 * PI), counts, enc_count);
+    }
+}
+
+static void motor_model_stop(uint64_t now_ns) {
+    (void)now_ns;
+    if (trace != NULL) {
+        fclose(trace);
+        trace = NULL;
+    }
+    if (sim_stats_enabled()) {
+        fprintf(stderr, "sim: motor at %.1f counts, peak %.0f rpm, %lu edges, pins at most %ld behind\r\n",
+                counts, w_peak / MOTOR_GEAR * 60 / (2 * PI), (unsigned long)edges, backlog_peak);
+    }
+}
+
+const sim_model_t sim_motor_model = {
+    .name = "motor",
+    .reset = motor_model_reset,
+    .step = motor_model_step,
+    .stop = motor_model_stop,
+};
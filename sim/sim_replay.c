@@ -0,0 +1,301 @@
+/**
+ * @file   sim_replay.c
+ *
+ * @brief  Host build: play a recorded input trace back into the firmware
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sim.h>
+#include <gpio_pin_yuhong.h>
+
+/*
+ * SIM_REPLAY=<file> takes the dump of a TRACE=1 build (AT+TRACE, see
+ * include/trace.h) and makes the same inputs happen at the same times,
+ * counted like the trace from trace_init's restart of the cycle counter
+ * (from start-up in a build without TRACE). Lines that are not trace events are skipped, so
+ * a whole console log will do. Each event is recreated so that the
+ * firmware sees it when it saw the original:
+ *
+ *   enc     the encoder pins go to the recorded AB state, one state per
+ *           step so the firmware takes an interrupt for each. The motor
+ *           plant lets go of the pins for the whole run.
+ *   button  the button is recorded on its release (pull-up, rising edge):
+ *           the line's pin is held low BUTTON_HOLD_NS before and let go.
+ *   key     keypad_read returns after the release: the key is held down
+ *           KEY_HOLD_NS before, its row following its column meanwhile.
+ *   uart    bytes with one timestamp came in as one burst; it goes on the
+ *           line early enough that its last stop bit plus the idle frame
+ *           end at the recorded time.
+ */
+
+/** @brief a button is held this long before its recorded release */
+#define BUTTON_HOLD_NS  (50000000ULL)
+/** @brief a key is held this long before keypad_read returned it */
+#define KEY_HOLD_NS     (100000000ULL)
+
+#define SYSCFG_EXTICR(n) (0x40013808 + 4 * (n))
+
+#define KEY_ROWS        (4)
+#define KEY_COLS        (3)
+
+/** @brief the keypad as keypad_driver.c scans it */
+static const char key_map[KEY_ROWS][KEY_COLS] = {
+    {'1', '2', '3'},
+    {'4', '5', '6'},
+    {'7', '8', '9'},
+    {'*', '0', '#'},
+};
+static const int row_ports[KEY_ROWS] = {ROW1_PORT, ROW2_PORT, ROW3_PORT, ROW4_PORT};
+static const int row_pins[KEY_ROWS] = {ROW1_PIN, ROW2_PIN, ROW3_PIN, ROW4_PIN};
+static const int col_ports[KEY_COLS] = {COL1_PORT, COL2_PORT, COL3_PORT};
+static const int col_pins[KEY_COLS] = {COL1_PIN, COL2_PIN, COL3_PIN};
+
+/** @brief what a pin action does */
+typedef enum {
+    REPLAY_ENC,         /**< drive the encoder pins to data */
+    REPLAY_LINE_DOWN,   /**< pull the pin of EXTI line data low */
+    REPLAY_LINE_UP,     /**< let go of it */
+    REPLAY_KEY_DOWN,    /**< hold key data */
+    REPLAY_KEY_UP,      /**< let go of it */
+} replay_kind_t;
+
+/** @brief one pin action */
+typedef struct {
+    uint64_t t_ns;
+    /** @brief order in the file, to keep equal times in order */
+    uint32_t seq;
+    uint8_t kind;
+    uint8_t data;
+} replay_action_t;
+
+/** @brief UART bytes the firmware took in at one time */
+typedef struct {
+    uint64_t t_ns;
+    size_t off;
+    size_t len;
+} replay_burst_t;
+
+/** @brief pin actions, in time order */
+static replay_action_t *actions;
+static size_t num_actions;
+static size_t next_action;
+
+/** @brief UART bursts in file order, their bytes, and how far the current one got */
+static replay_burst_t *bursts;
+static size_t num_bursts;
+static size_t next_burst;
+static size_t burst_sent;
+static uint8_t *uart_bytes;
+static size_t num_uart_bytes;
+
+/** @brief the key held down, -1 if none */
+static int key_row = -1;
+static int key_col = -1;
+
+/** @brief the trace has encoder events */
+static int owns_encoder;
+/** @brief the end was reported */
+static int finished;
+
+int sim_replay_encoder(void) {
+    return owns_encoder;
+}
+
+/**
+ * @brief grow *array by one element of size, returning the new element
+ */
+static void *replay_append(void *array, size_t *count, size_t size) {
+    void **ptr = (void **)array;
+    *ptr = realloc(*ptr, (*count + 1) * size);
+    if (*ptr == NULL) {
+        sim_fatal("out of memory reading SIM_REPLAY");
+    }
+    return (uint8_t *)*ptr + (*count)++ * size;
+}
+
+static void replay_action(uint64_t t_ns, uint8_t kind, uint8_t data) {
+    replay_action_t *action = replay_append(&actions, &num_actions, sizeof(*action));
+    action->t_ns = t_ns;
+    action->seq = num_actions;
+    action->kind = kind;
+    action->data = data;
+}
+
+static int replay_compare(const void *a, const void *b) {
+    const replay_action_t *x = a, *y = b;
+    if (x->t_ns != y->t_ns) {
+        return (x->t_ns < y->t_ns) ? -1 : 1;
+    }
+    return (x->seq < y->seq) ? -1 : (x->seq > y->seq);
+}
+
+/**
+ * @brief turn one trace line into actions; other lines are ignored
+ */
+static void replay_parse(const char *line) {
+    uint64_t t_us;
+    char event[16];
+    unsigned int data;
+
+    if (sscanf(line, "trace,%" SCNu64 ",%15[^,],%u", &t_us, event, &data) != 3) {
+        return;
+    }
+    uint64_t t_ns = t_us * 1000;
+    if (strcmp(event, "enc") == 0) {
+        replay_action(t_ns, REPLAY_ENC, data);
+        owns_encoder = 1;
+    } else if (strcmp(event, "button") == 0) {
+        replay_action((t_ns > BUTTON_HOLD_NS) ? t_ns - BUTTON_HOLD_NS : 0, REPLAY_LINE_DOWN, data);
+        replay_action(t_ns, REPLAY_LINE_UP, data);
+    } else if (strcmp(event, "key") == 0) {
+        replay_action((t_ns > KEY_HOLD_NS) ? t_ns - KEY_HOLD_NS : 0, REPLAY_KEY_DOWN, data);
+        replay_action(t_ns, REPLAY_KEY_UP, data);
+    } else if (strcmp(event, "uart") == 0) {
+        if (num_bursts == 0 || bursts[num_bursts - 1].t_ns != t_ns) {
+            replay_burst_t *burst = replay_append(&bursts, &num_bursts, sizeof(*burst));
+            burst->t_ns = t_ns;
+            burst->off = num_uart_bytes;
+            burst->len = 0;
+        }
+        *(uint8_t *)replay_append(&uart_bytes, &num_uart_bytes, 1) = data;
+        bursts[num_bursts - 1].len++;
+    }
+}
+
+/**
+ * @brief while a key is down its row reads its column, as through the switch
+ */
+static void replay_keypad(void) {
+    if (key_row < 0) {
+        return;
+    }
+    if (sim_gpio_output(col_ports[key_col], col_pins[key_col])) {
+        sim_gpio_release(row_ports[key_row], row_pins[key_row]);
+    } else {
+        sim_gpio_drive(row_ports[key_row], row_pins[key_row], 0);
+    }
+}
+
+/**
+ * @brief port of the pin routed to EXTI line, as the firmware set SYSCFG up
+ */
+static int replay_line_port(int line) {
+    return (SIM_REG(SYSCFG_EXTICR(line / 4)) >> (4 * (line % 4))) & 0xF;
+}
+
+static void replay_apply(const replay_action_t *action) {
+    switch (action->kind) {
+    case REPLAY_ENC:
+        sim_gpio_drive(ENC_A_PORT, ENC_A_PIN, (action->data >> 1) & 1);
+        sim_gpio_drive(ENC_B_PORT, ENC_B_PIN, action->data & 1);
+        break;
+    case REPLAY_LINE_DOWN:
+        sim_gpio_drive(replay_line_port(action->data), action->data, 0);
+        break;
+    case REPLAY_LINE_UP:
+        sim_gpio_release(replay_line_port(action->data), action->data);
+        break;
+    case REPLAY_KEY_DOWN:
+        for (int row = 0; row < KEY_ROWS; row++) {
+            for (int col = 0; col < KEY_COLS; col++) {
+                if (key_map[row][col] == (char)action->data) {
+                    key_row = row;
+                    key_col = col;
+                }
+            }
+        }
+        replay_keypad();
+        break;
+    case REPLAY_KEY_UP:
+        if (key_row >= 0) {
+            sim_gpio_release(row_ports[key_row], row_pins[key_row]);
+        }
+        key_row = key_col = -1;
+        break;
+    default:
+        break;
+    }
+}
+
+static void replay_model_reset(void) {
+    const char *path = getenv("SIM_REPLAY");
+    if (path == NULL || path[0] == '\0') {
+        return;
+    }
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        sim_fatal("cannot open SIM_REPLAY file %s", path);
+    }
+    char *line = NULL;
+    size_t cap = 0;
+    while (getline(&line, &cap, file) >= 0) {
+        replay_parse(line);
+    }
+    free(line);
+    fclose(file);
+    qsort(actions, num_actions, sizeof(*actions), replay_compare);
+}
+
+static void replay_model_step(uint64_t now_ns) {
+    uint64_t t_ns = now_ns - sim_dwt_epoch_ns();
+
+    // one at a time: two edges in one step would be one EXTI interrupt
+    if (next_action < num_actions && actions[next_action].t_ns <= t_ns) {
+        replay_apply(&actions[next_action++]);
+    }
+    replay_keypad();
+
+    while (next_burst < num_bursts) {
+        const replay_burst_t *burst = &bursts[next_burst];
+        uint64_t lead = (burst->len + 1) * sim_uart_frame_ns();
+        if (burst_sent == 0 && t_ns + lead < burst->t_ns) {
+            break;
+        }
+        burst_sent += sim_uart_inject(&uart_bytes[burst->off + burst_sent], burst->len - burst_sent, now_ns);
+        if (burst_sent < burst->len) {
+            break; // the line's queue is full, the rest goes next step
+        }
+        next_burst++;
+        burst_sent = 0;
+    }
+
+    if (!finished && (num_actions + num_bursts) > 0 && next_action == num_actions && next_burst == num_bursts) {
+        finished = 1;
+        fprintf(stderr, "sim: replay done at %.1f ms\r\n", t_ns / 1e6);
+    }
+}
+
+/**
+ * @brief a column the keypad scan just drove shows on the held key's row
+ *        before the firmware reads the rows
+ */
+static void replay_model_access(uintptr_t addr, int write, uint64_t now_ns) {
+    (void)addr;
+    (void)now_ns;
+    if (write) {
+        replay_keypad();
+    }
+}
+
+static void replay_model_stop(uint64_t now_ns) {
+    (void)now_ns;
+    if (sim_stats_enabled() && (num_actions + num_bursts) > 0) {
+        fprintf(stderr, "sim: replay %zu of %zu pin actions, %zu of %zu uart bursts\r\n",
+                next_action, num_actions, next_burst, num_bursts);
+    }
+}
+
+const sim_model_t sim_replay_model = {
+    .name = "replay",
+    .reset = replay_model_reset,
+    .step = replay_model_step,
+    .access = replay_model_access,
+    .stop = replay_model_stop,
+};
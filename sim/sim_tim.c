@@ -0,0 +1,203 @@
+/**
+ * @file   sim_tim.c
+ *
+ * @brief  Host build: the TIM2-TIM5 time bases and the TIM1 encoder interface
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <string.h>
+#include <sim.h>
+
+/*
+ * Up-counting only. CNT advances at APB1 x1 / (PSC + 1) while CEN is set and
+ * the RCC clock of the timer is on, wraps after ARR and sets UIF, which
+ * raises the timer's IRQ when UIE is set. Overflows that land in the same
+ * hardware step merge into one UIF, as they would if the ISR fell behind.
+ * CNT moves once per step; a driver that needs it between steps marks the
+ * read with MMIO_READ.
+ *
+ * TIM1 only has its encoder mode (SMS = 011): every edge of PA8 (TI1) or
+ * PA9 (TI2) in alternate function 1 moves CNT by one, in the direction the
+ * other input's level gives (RM0368 "Counting direction versus encoder
+ * signals"), wrapping in [0, ARR] with UIF and, if UIE is set, the
+ * TIM1_UP IRQ. Input filters are not modelled.
+ */
+
+#define TIM_FIRST       (2)
+#define TIM_LAST        (5)
+#define TIM_COUNT       (TIM_LAST - TIM_FIRST + 1)
+#define TIM_BASE(n)     (0x40000000UL + 0x400UL * ((n) - TIM_FIRST))
+#define TIM_CR1(n)      (TIM_BASE(n) + 0x00)
+#define TIM_DIER(n)     (TIM_BASE(n) + 0x0C)
+#define TIM_SR(n)       (TIM_BASE(n) + 0x10)
+#define TIM_EGR(n)      (TIM_BASE(n) + 0x14)
+#define TIM_CNT(n)      (TIM_BASE(n) + 0x24)
+#define TIM_PSC(n)      (TIM_BASE(n) + 0x28)
+#define TIM_ARR(n)      (TIM_BASE(n) + 0x2C)
+#define TIM_CR1_CEN     (1 << 0)
+#define TIM_DIER_UIE    (1 << 0)
+#define TIM_SR_UIF      (1 << 0)
+#define TIM_EGR_UG      (1 << 0)
+
+#define TIM1_BASE       (0x40010000UL)
+#define TIM1_CR1        (TIM1_BASE + 0x00)
+#define TIM1_SMCR       (TIM1_BASE + 0x08)
+#define TIM1_DIER       (TIM1_BASE + 0x0C)
+#define TIM1_SR         (TIM1_BASE + 0x10)
+#define TIM1_UP_IRQ     (25)
+#define TIM1_CCER       (TIM1_BASE + 0x20)
+#define TIM1_CNT        (TIM1_BASE + 0x24)
+#define TIM1_ARR        (TIM1_BASE + 0x2C)
+#define TIM1_SMCR_SMS   (0x7)
+#define TIM1_SMS_ENC3   (0x3)
+#define TIM_CCER_CC1P   (1 << 1)
+#define TIM_CCER_CC2P   (1 << 5)
+#define TIM1_TI1_PIN    (8)
+#define TIM1_TI2_PIN    (9)
+#define GPIOA_MODER     (0x40020000UL)
+#define GPIOA_IDR       (0x40020010UL)
+#define GPIOA_AFRH      (0x40020024UL)
+#define GPIO_MODE_ALT   (0x2)
+#define TIM1_AF         (1)
+
+#define RCC_APB1ENR     (0x40023840)
+#define RCC_APB2ENR     (0x40023844)
+#define TIM1_CLKEN      (1 << 0)
+/** @brief TIM2..TIM5 clock enables are APB1ENR bits 0..3 */
+#define TIM_CLKEN(n)    (1 << ((n) - TIM_FIRST))
+
+/** @brief NVIC lines of TIM2..TIM5 */
+static const int tim_irq[TIM_COUNT] = {28, 29, 30, 50};
+
+/** @brief per timer: host time already turned into timer clocks, and the
+ *         prescaler's count towards the next CNT tick */
+static struct {
+    uint64_t last_ns;
+    uint32_t prescaler;
+} tims[TIM_COUNT];
+
+/**
+ * @brief TIM2 and TIM5 have 32-bit counters, TIM3 and TIM4 16-bit ones
+ */
+static uint32_t tim_mask(int n) {
+    return (n == 2 || n == 5) ? 0xFFFFFFFFUL : 0xFFFFUL;
+}
+
+/**
+ * @brief bring timer n up to now_ns
+ */
+static void tim_advance(int n, uint64_t now_ns) {
+    int i = n - TIM_FIRST;
+    uint64_t clocks = (now_ns - tims[i].last_ns) * (SIM_CPU_HZ / 1000000) / 1000;
+    if (clocks == 0) {
+        return;
+    }
+    tims[i].last_ns += clocks * 1000 / (SIM_CPU_HZ / 1000000);
+
+    if (!(SIM_REG(TIM_CR1(n)) & TIM_CR1_CEN) || !(SIM_REG(RCC_APB1ENR) & TIM_CLKEN(n))) {
+        return;
+    }
+    uint64_t psc = (SIM_REG(TIM_PSC(n)) & 0xFFFF) + 1;
+    uint64_t total = tims[i].prescaler + clocks;
+    uint64_t ticks = total / psc;
+    tims[i].prescaler = (uint32_t)(total % psc);
+
+    uint64_t arr = SIM_REG(TIM_ARR(n)) & tim_mask(n);
+    if (ticks == 0 || arr == 0) {
+        // ARR = 0 holds the counter
+        return;
+    }
+    uint64_t cnt = (SIM_REG(TIM_CNT(n)) & tim_mask(n)) + ticks;
+    if (cnt > arr) {
+        cnt = (cnt - arr - 1) % (arr + 1);
+        SIM_SET_BITS(TIM_SR(n), TIM_SR_UIF);
+        if (SIM_REG(TIM_DIER(n)) & TIM_DIER_UIE) {
+            sim_irq_raise(tim_irq[i]);
+        }
+    }
+    SIM_REG(TIM_CNT(n)) = (uint32_t)cnt;
+}
+
+/**
+ * @brief true if PA pin is handed to TIM1
+ */
+static int tim1_pin(int pin) {
+    uint32_t mode = (SIM_REG(GPIOA_MODER) >> (2 * pin)) & 0x3;
+    uint32_t af = (SIM_REG(GPIOA_AFRH) >> (4 * (pin - 8))) & 0xF;
+    return mode == GPIO_MODE_ALT && af == TIM1_AF;
+}
+
+void sim_tim_input(int port, int pin) {
+    if (port != 0 || (pin != TIM1_TI1_PIN && pin != TIM1_TI2_PIN) || !tim1_pin(pin)) {
+        return;
+    }
+    if (!(SIM_REG(RCC_APB2ENR) & TIM1_CLKEN) || !(SIM_REG(TIM1_CR1) & TIM_CR1_CEN) ||
+        (SIM_REG(TIM1_SMCR) & TIM1_SMCR_SMS) != TIM1_SMS_ENC3) {
+        return;
+    }
+    uint32_t idr = SIM_REG(GPIOA_IDR);
+    uint32_t ccer = SIM_REG(TIM1_CCER);
+    int ti1 = ((idr >> TIM1_TI1_PIN) & 1) ^ ((ccer & TIM_CCER_CC1P) != 0);
+    int ti2 = ((idr >> TIM1_TI2_PIN) & 1) ^ ((ccer & TIM_CCER_CC2P) != 0);
+    // an edge on TI1 counts up when TI1 != TI2 afterwards, on TI2 when they agree
+    int up = (pin == TIM1_TI1_PIN) ? (ti1 != ti2) : (ti1 == ti2);
+
+    uint32_t arr = SIM_REG(TIM1_ARR) & 0xFFFF;
+    uint32_t cnt = SIM_REG(TIM1_CNT) & 0xFFFF;
+    int wrap;
+    if (up) {
+        wrap = (cnt >= arr);
+        cnt = wrap ? 0 : cnt + 1;
+    } else {
+        wrap = (cnt == 0 || cnt > arr);
+        cnt = wrap ? arr : cnt - 1;
+    }
+    SIM_REG(TIM1_CNT) = cnt;
+    if (wrap) {
+        SIM_SET_BITS(TIM1_SR, TIM_SR_UIF);
+        if (SIM_REG(TIM1_DIER) & TIM_DIER_UIE) {
+            sim_irq_raise(TIM1_UP_IRQ);
+        }
+    }
+}
+
+static void tim_model_reset(void) {
+    memset(tims, 0, sizeof(tims));
+}
+
+static void tim_model_step(uint64_t now_ns) {
+    for (int n = TIM_FIRST; n <= TIM_LAST; n++) {
+        tim_advance(n, now_ns);
+    }
+}
+
+/**
+ * @brief a marked CNT read brings the counter up to date; UG restarts the
+ *        count and sets UIF
+ */
+static void tim_model_access(uintptr_t addr, int write, uint64_t now_ns) {
+    for (int n = TIM_FIRST; n <= TIM_LAST; n++) {
+        if (!write && addr == TIM_CNT(n)) {
+            tim_advance(n, now_ns);
+        } else if (write && addr == TIM_EGR(n) && (SIM_REG(addr) & TIM_EGR_UG)) {
+            tim_advance(n, now_ns);
+            tims[n - TIM_FIRST].prescaler = 0;
+            SIM_REG(TIM_CNT(n)) = 0;
+            SIM_REG(addr) = 0;
+            SIM_SET_BITS(TIM_SR(n), TIM_SR_UIF);
+            if (SIM_REG(TIM_DIER(n)) & TIM_DIER_UIE) {
+                sim_irq_raise(tim_irq[n - TIM_FIRST]);
+            }
+        }
+    }
+}
+
+const sim_model_t sim_tim_model = {
+    .name = "tim",
+    .reset = tim_model_reset,
+    .step = tim_model_step,
+    .access = tim_model_access,
+};
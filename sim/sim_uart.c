@@ -0,0 +1,378 @@
+/**
+ * @file   sim_uart.c
+ *
+ * @brief  Host build: USART2 and its DMA1 streams, wired to the terminal
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#define _GNU_SOURCE
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <uart.h>
+#include <sim.h>
+
+/*
+ * What the TX DMA moves into DR comes out on stdout, and stdin is what the
+ * RX pin receives. Both directions run at the line rate BRR gives, one
+ * start bit, the word and one stop bit per byte, so the DMA, TC and IDLE
+ * events come when they would on the wire. With CTSE set (flow control
+ * built in) the terminal holds off while the firmware keeps RTS (PA1) high.
+ */
+
+#define USART2_SR       (0x40004400)
+#define USART2_DR       (0x40004404)
+#define USART2_BRR      (0x40004408)
+#define USART2_CR1      (0x4000440C)
+#define USART2_CR3      (0x40004414)
+#define USART_SR_FE     (1 << 1)
+#define USART_SR_NF     (1 << 2)
+#define USART_SR_ORE    (1 << 3)
+#define USART_SR_IDLE   (1 << 4)
+#define USART_SR_TC     (1 << 6)
+#define USART_SR_TXE    (1 << 7)
+#define USART_CR1_RE    (1 << 2)
+#define USART_CR1_TE    (1 << 3)
+#define USART_CR1_IDLEIE (1 << 4)
+#define USART_CR1_M     (1 << 12)
+#define USART_CR1_UE    (1 << 13)
+#define USART_CR1_OVER8 (1 << 15)
+#define USART_CR3_DMAR  (1 << 6)
+#define USART_CR3_DMAT  (1 << 7)
+#define USART_CR3_CTSE  (1 << 9)
+#define USART_RTS_PORT  (0)
+#define USART_RTS_PIN   (1)
+#define USART2_IRQ      (38)
+
+#define DMA1_BASE       (0x40026000)
+#define DMA_HISR        (DMA1_BASE + 0x04)
+#define DMA_HIFCR       (DMA1_BASE + 0x0C)
+#define DMA_SCR(n)      (DMA1_BASE + 0x10 + 0x18 * (n))
+#define DMA_SNDTR(n)    (DMA_SCR(n) + 0x04)
+#define DMA_SM0AR(n)    (DMA_SCR(n) + 0x0C)
+#define DMA_SxCR_EN     (1 << 0)
+#define DMA_SxCR_HTIE   (1 << 3)
+#define DMA_SxCR_TCIE   (1 << 4)
+#define DMA_HTIF        (1 << 4)
+#define DMA_TCIF        (1 << 5)
+/** @brief flag group of streams 4-7 inside HISR / HIFCR */
+#define DMA_HSHIFT(n)   ((n) == 4 ? 0 : (n) == 5 ? 6 : (n) == 6 ? 16 : 22)
+
+#define RX_STREAM       (5)
+#define TX_STREAM       (6)
+#define DMA1_IRQ(n)     (11 + (n))
+
+/** @brief stdin bytes waiting for the line */
+#define RX_QUEUE        (64)
+
+/** @brief NDTR the RX stream was started with, reloaded in circular mode */
+static uint32_t rx_len;
+/** @brief stdin is closed, stop polling it */
+static int rx_eof;
+/** @brief read from stdin, not on the wire yet */
+static uint8_t rx_queue[RX_QUEUE];
+static uint32_t rx_head;
+static uint32_t rx_count;
+/** @brief host time the next byte is complete, and the last one was */
+static uint64_t rx_next_ns;
+static uint64_t rx_last_ns;
+/** @brief bytes came in since the last IDLE */
+static int rx_idle_armed;
+
+/** @brief next byte of the TX stream */
+static uintptr_t tx_addr;
+/** @brief host time the transmitter is done with what it has */
+static uint64_t tx_free_ns;
+/** @brief TC is due once the line is free */
+static int tx_tc_armed;
+
+/** @brief traffic, for the SIM_STATS report */
+static uint64_t tx_bytes;
+static uint64_t rx_bytes;
+static uint64_t tx_busy_ns;
+
+/** @brief terminal settings to put back on exit */
+static struct termios tty_saved;
+static int tty_raw;
+
+static void tty_restore(void) {
+    if (tty_raw) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &tty_saved);
+        tty_raw = 0;
+    }
+}
+
+/**
+ * @brief give keys to the firmware one at a time and let it do the echo,
+ *        as a serial terminal would; ^C still ends the simulation
+ */
+static void tty_setup(void) {
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &tty_saved) != 0) {
+        return;
+    }
+    struct termios raw = tty_saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) {
+        return;
+    }
+    tty_raw = 1;
+}
+
+/**
+ * @brief one frame on the wire, in ns: start bit, 8 or 9 data bits, stop bit
+ *        at the rate of BRR and OVER8 against the 16 MHz APB1 clock
+ */
+static uint64_t uart_frame_ns(void) {
+    uint32_t brr = SIM_REG(USART2_BRR) & 0xFFFF;
+    uint32_t cr1 = SIM_REG(USART2_CR1);
+    uint32_t div = (cr1 & USART_CR1_OVER8) ? ((brr >> 4) << 3) + (brr & 0x7) : brr;
+    uint32_t bits = (cr1 & USART_CR1_M) ? 11 : 10;
+    if (div == 0) {
+        div = 1;
+    }
+    return (uint64_t)bits * div * 1000000000ULL / SIM_CPU_HZ;
+}
+
+uint64_t sim_uart_frame_ns(void) {
+    return uart_frame_ns();
+}
+
+/**
+ * @brief raise the DMA1 stream interrupt if one of its enabled events fired
+ */
+static void dma_event(int stream, uint32_t flags) {
+    uint32_t cr = SIM_REG(DMA_SCR(stream));
+    SIM_REG(DMA_HISR) |= flags << DMA_HSHIFT(stream);
+    if (((flags & DMA_TCIF) && (cr & DMA_SxCR_TCIE)) || ((flags & DMA_HTIF) && (cr & DMA_SxCR_HTIE))) {
+        sim_irq_raise(DMA1_IRQ(stream));
+    }
+}
+
+/**
+ * @brief the TX stream feeds DR a byte whenever the transmitter takes one;
+ *        they go out on stdout, TC once the last stop bit is done
+ */
+static void uart_tx_step(uint64_t now_ns) {
+    uint32_t cr1 = SIM_REG(USART2_CR1);
+    uint8_t out[256];
+    uint32_t n = 0;
+
+    if ((SIM_REG(DMA_SCR(TX_STREAM)) & DMA_SxCR_EN) && (SIM_REG(USART2_CR3) & USART_CR3_DMAT)
+        && (cr1 & (USART_CR1_UE | USART_CR1_TE)) == (USART_CR1_UE | USART_CR1_TE)) {
+        uint64_t frame = uart_frame_ns();
+        uint32_t ndtr = SIM_REG(DMA_SNDTR(TX_STREAM)) & 0xFFFF;
+
+        while (ndtr > 0 && tx_free_ns <= now_ns && n < sizeof(out)) {
+            out[n++] = *(const uint8_t *)tx_addr++;
+            ndtr--;
+            tx_free_ns += frame;
+            tx_busy_ns += frame;
+        }
+        SIM_REG(DMA_SNDTR(TX_STREAM)) = ndtr;
+        if (ndtr == 0) {
+            SIM_CLR_BITS(DMA_SCR(TX_STREAM), DMA_SxCR_EN);
+            dma_event(TX_STREAM, DMA_TCIF);
+            tx_tc_armed = 1;
+        }
+    }
+
+    for (uint32_t done = 0; done < n;) {
+        ssize_t w = __real_write(STDOUT_FILENO, out + done, n - done);
+        if (w <= 0) {
+            break;
+        }
+        done += w;
+    }
+    tx_bytes += n;
+
+    if (tx_tc_armed && tx_free_ns <= now_ns && !(SIM_REG(DMA_SCR(TX_STREAM)) & DMA_SxCR_EN)) {
+        tx_tc_armed = 0;
+        SIM_SET_BITS(USART2_SR, USART_SR_TC | USART_SR_TXE);
+    }
+}
+
+/**
+ * @brief one byte off the RX pin: through the RX stream into the firmware's
+ *        ring, or an overrun if nobody is taking it
+ */
+static void uart_rx_byte(uint8_t byte) {
+    uint32_t cr1 = SIM_REG(USART2_CR1);
+    if (!(SIM_REG(DMA_SCR(RX_STREAM)) & DMA_SxCR_EN) || !(SIM_REG(USART2_CR3) & USART_CR3_DMAR) || rx_len == 0) {
+        if ((cr1 & (USART_CR1_UE | USART_CR1_RE)) == (USART_CR1_UE | USART_CR1_RE)) {
+            SIM_SET_BITS(USART2_SR, USART_SR_ORE);
+        }
+        return;
+    }
+
+    uint8_t *dst = (uint8_t *)(uintptr_t)SIM_REG(DMA_SM0AR(RX_STREAM));
+    uint32_t ndtr = SIM_REG(DMA_SNDTR(RX_STREAM));
+    dst[rx_len - ndtr] = byte;
+    ndtr--;
+    if (ndtr == rx_len / 2) {
+        dma_event(RX_STREAM, DMA_HTIF);
+    }
+    if (ndtr == 0) {
+        ndtr = rx_len; // circular
+        dma_event(RX_STREAM, DMA_TCIF);
+    }
+    SIM_REG(DMA_SNDTR(RX_STREAM)) = ndtr;
+    rx_bytes++;
+}
+
+/**
+ * @brief stdin goes onto the RX line a frame at a time; a frame time of
+ *        silence after the last byte is an idle line
+ */
+static void uart_rx_step(uint64_t now_ns) {
+    uint32_t cr1 = SIM_REG(USART2_CR1);
+    uint64_t frame = uart_frame_ns();
+
+    if (rx_count == 0 && !rx_eof) {
+        struct pollfd pfd = {.fd = STDIN_FILENO, .events = POLLIN};
+        if (poll(&pfd, 1, 0) > 0) {
+            ssize_t n = __real_read(STDIN_FILENO, rx_queue, sizeof(rx_queue));
+            if (n <= 0) {
+                rx_eof = 1;
+            } else {
+                rx_head = 0;
+                rx_count = n;
+                if (rx_next_ns < now_ns) {
+                    rx_next_ns = now_ns + frame;
+                }
+            }
+        }
+    }
+
+    if ((cr1 & (USART_CR1_UE | USART_CR1_RE)) != (USART_CR1_UE | USART_CR1_RE)) {
+        // the terminal sends regardless, into a receiver that is off
+        rx_count = 0;
+        return;
+    }
+    if ((SIM_REG(USART2_CR3) & USART_CR3_CTSE) && sim_gpio_output(USART_RTS_PORT, USART_RTS_PIN)) {
+        rx_next_ns = now_ns + frame;
+    }
+    while (rx_count > 0 && rx_next_ns <= now_ns) {
+        uart_rx_byte(rx_queue[rx_head++]);
+        rx_count--;
+        rx_last_ns = rx_next_ns;
+        rx_next_ns += frame;
+        rx_idle_armed = 1;
+    }
+
+    if (rx_idle_armed && rx_count == 0 && now_ns >= rx_last_ns + frame) {
+        rx_idle_armed = 0;
+        SIM_SET_BITS(USART2_SR, USART_SR_IDLE);
+        if (cr1 & USART_CR1_IDLEIE) {
+            sim_irq_raise(USART2_IRQ);
+        }
+    }
+}
+
+size_t sim_uart_inject(const uint8_t *data, size_t len, uint64_t now_ns) {
+    if (rx_count == 0) {
+        rx_head = 0;
+        if (rx_next_ns < now_ns) {
+            rx_next_ns = now_ns + uart_frame_ns();
+        }
+    } else if (rx_head + rx_count + len > RX_QUEUE) {
+        memmove(rx_queue, &rx_queue[rx_head], rx_count);
+        rx_head = 0;
+    }
+    size_t room = RX_QUEUE - rx_head - rx_count;
+    size_t n = (len < room) ? len : room;
+    memcpy(&rx_queue[rx_head + rx_count], data, n);
+    rx_count += n;
+    return n;
+}
+
+static void uart_model_reset(void) {
+    SIM_REG(USART2_SR) = USART_SR_TC | USART_SR_TXE;
+    rx_len = 0;
+    rx_eof = 0;
+    rx_count = 0;
+    rx_next_ns = 0;
+    rx_idle_armed = 0;
+    tx_free_ns = 0;
+    tx_tc_armed = 0;
+    tx_bytes = rx_bytes = tx_busy_ns = 0;
+    tty_setup();
+}
+
+static void uart_model_step(uint64_t now_ns) {
+    uart_tx_step(now_ns);
+    uart_rx_step(now_ns);
+}
+
+/**
+ * @brief HIFCR clears flags; EN starts a stream; SR-then-DR clears the
+ *        receive status
+ */
+static void uart_model_access(uintptr_t addr, int write, uint64_t now_ns) {
+    if (write && addr == DMA_HIFCR) {
+        SIM_REG(DMA_HISR) &= ~SIM_REG(DMA_HIFCR);
+        SIM_REG(DMA_HIFCR) = 0;
+    } else if (write && addr == DMA_SCR(RX_STREAM)) {
+        if (SIM_REG(addr) & DMA_SxCR_EN) {
+            rx_len = SIM_REG(DMA_SNDTR(RX_STREAM)) & 0xFFFF;
+        }
+    } else if (write && addr == DMA_SCR(TX_STREAM)) {
+        if (SIM_REG(addr) & DMA_SxCR_EN) {
+            tx_addr = SIM_REG(DMA_SM0AR(TX_STREAM));
+            if (tx_free_ns < now_ns) {
+                tx_free_ns = now_ns;
+            }
+            tx_tc_armed = 0;
+            SIM_CLR_BITS(USART2_SR, USART_SR_TC);
+        }
+    } else if (!write && addr == USART2_DR) {
+        SIM_CLR_BITS(USART2_SR, USART_SR_IDLE | USART_SR_ORE | USART_SR_NF | USART_SR_FE);
+    }
+}
+
+/**
+ * @brief give the terminal back; report what went over the line and how
+ *        busy the TX side kept it
+ */
+static void uart_model_stop(uint64_t now_ns) {
+    tty_restore();
+    if (sim_stats_enabled() && now_ns != 0) {
+        fprintf(stderr, "sim: usart2 %llu baud, tx %llu bytes (%.1f%% of the line), rx %llu bytes\r\n",
+                (unsigned long long)(10000000000ULL / uart_frame_ns()), (unsigned long long)tx_bytes,
+                100.0 * tx_busy_ns / now_ns, (unsigned long long)rx_bytes);
+    }
+}
+
+const sim_model_t sim_uart_model = {
+    .name = "usart2",
+    .reset = uart_model_reset,
+    .step = uart_model_step,
+    .access = uart_model_access,
+    .stop = uart_model_stop,
+};
+
+/**
+ * @brief the firmware's console I/O: on the board newlib sends fd 0 / 1
+ *        through _read / _write to the UART driver, here the linker does
+ *        (-Wl,--wrap=read,--wrap=write)
+ */
+ssize_t __wrap_read(int fd, void *buf, size_t len) {
+    if (fd == STDIN_FILENO) {
+        return uart_read(fd, buf, (int)len);
+    }
+    return __real_read(fd, buf, len);
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t len) {
+    if (fd == STDOUT_FILENO) {
+        return uart_write(fd, (char *)buf, (int)len);
+    }
+    return __real_write(fd, buf, len);
+}
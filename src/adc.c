@@ -16,6 +16,7 @@
 #include <rcc.h>
 #include <unistd.h>
 #include <adc.h>
+#include <mmio.h>
 #include "semphr.h"
 
 /** @brief The ADC register map. */
@@ -121,11 +122,13 @@ uint16_t adc_read_chan(uint8_t chan){
 		// adc->SQR3 &= ~ADC1_SQR3_SQ1;
 		adc->SQR3 = chan;
 		adc->CR2 |= ADC1_CR2_SWSTART;
+		MMIO_WRITTEN(adc->CR2);
 		vTaskDelay(pdMS_TO_TICKS(15));
 
 		while (!(adc->SR & ADC1_SR_EOC)) {};
 		taskEXIT_CRITICAL();
 		adc_val = adc->DR;
+		MMIO_READ(adc->DR);
 		xSemaphoreGive(adc_mutex);
 	}
 	return adc_val;
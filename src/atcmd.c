@@ -12,7 +12,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <log.h>
 
 
 /** @brief define unused variables */
@@ -58,12 +58,12 @@ uint8_t atcmd_detect_escape(UNUSED atcmd_parser_t *parser, UNUSED char c) {
 uint8_t atcmd_parse(UNUSED atcmd_parser_t *parser, UNUSED char *cmd) {
 
     if (cmd == NULL || parser == NULL) {
-        printf("Command or Parser is NULL.\n");
+        LOG("Command or Parser is NULL.\n");
     }
 
     // command doesn't start with AT+
     if (strncmp(cmd, "AT+", 3) != 0) {
-        printf("Command does not start with 'AT+'.\n");
+        LOG("Command does not start with 'AT+'.\n");
         return 0; // Command is not valid
     }
 
@@ -79,13 +79,13 @@ uint8_t atcmd_parse(UNUSED atcmd_parser_t *parser, UNUSED char *cmd) {
                 // printf("Command '%s' executed successfully.\n", parser->atcmds[i].cmdstr);
                 return 1; // Command executed successfully
             } else {
-                printf("Command '%s' failed to execute.\n", parser->atcmds[i].cmdstr);
+                LOG("Command '%s' failed to execute.\n", parser->atcmds[i].cmdstr);
                 return 0; // Command execution failed
             }
         }
     }
 
     // If no command matches
-    printf("Invalid or unrecognized command.\n");
+    LOG("Invalid or unrecognized command.\n");
     return 0; // Command is not valid
 }
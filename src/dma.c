@@ -0,0 +1,113 @@
+/**
+ * @file dma.c
+ *
+ * @brief DMA1/DMA2 stream helpers used by the peripheral drivers
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <stdint.h>
+#include <dma.h>
+#include <rcc.h>
+#include <mmio.h>
+
+/** @brief The register map of one DMA stream. */
+struct dma_stream_reg_map {
+    volatile uint32_t CR;   /**< 00 Configuration Register */
+    volatile uint32_t NDTR; /**< 04 Number of Data Register */
+    volatile uint32_t PAR;  /**< 08 Peripheral Address Register */
+    volatile uint32_t M0AR; /**< 0C Memory 0 Address Register */
+    volatile uint32_t M1AR; /**< 10 Memory 1 Address Register */
+    volatile uint32_t FCR;  /**< 14 FIFO Control Register */
+};
+
+/** @brief The DMA controller register map. */
+struct dma_reg_map {
+    volatile uint32_t LISR;  /**< 00 Low Interrupt Status Register (streams 0-3) */
+    volatile uint32_t HISR;  /**< 04 High Interrupt Status Register (streams 4-7) */
+    volatile uint32_t LIFCR; /**< 08 Low Interrupt Flag Clear Register */
+    volatile uint32_t HIFCR; /**< 0C High Interrupt Flag Clear Register */
+    struct dma_stream_reg_map stream[8]; /**< 10-CC Stream registers */
+};
+
+/** @brief Base addresses of DMA1 and DMA2 */
+struct dma_reg_map* const dma_base[] = {(void *)0x0,          // N/A
+                                        (void *)0x40026000,   // DMA 1 Base Address
+                                        (void *)0x40026400};  // DMA 2 Base Address
+
+/** @brief Bit offset of each stream's flag group inside xISR/xIFCR */
+static const uint8_t dma_flag_shift[4] = {0, 6, 16, 22};
+
+/**
+ * @brief  Enables the controller clock, disables the stream and programs the
+ *         peripheral side of the transfer.
+ */
+void dma_stream_init(int dma, int stream, uint32_t channel, volatile void *periph_addr, uint32_t cr) {
+    if (dma < 1 || dma > 2 || stream < 0 || stream > 7) return;
+    struct rcc_reg_map *rcc = RCC_BASE;
+    rcc->ahb1_enr |= (dma == 1) ? DMA1_CLKEN : DMA2_CLKEN;
+
+    dma_stream_stop(dma, stream);
+    dma_clear_flags(dma, stream, DMA_ALL_FLAGS);
+
+    struct dma_stream_reg_map *s = &dma_base[dma]->stream[stream];
+    s->PAR = (uint32_t)(uintptr_t)periph_addr;
+    s->CR = (channel << DMA_SxCR_CHSEL_POS) | (cr & ~DMA_SxCR_EN);
+    s->FCR = 0; // direct mode
+}
+
+/**
+ * @brief  Loads a memory span into a disabled stream and starts it. Any flags
+ *         left over from the previous transfer must be cleared before EN is set.
+ */
+void dma_stream_start(int dma, int stream, volatile void *mem, uint16_t len) {
+    struct dma_stream_reg_map *s = &dma_base[dma]->stream[stream];
+    dma_clear_flags(dma, stream, DMA_ALL_FLAGS);
+    s->M0AR = (uint32_t)(uintptr_t)mem;
+    s->NDTR = len;
+    s->CR |= DMA_SxCR_EN;
+    MMIO_WRITTEN(s->CR);
+}
+
+/**
+ * @brief  Disables a stream. EN reads back as 1 until the current beat is done.
+ */
+void dma_stream_stop(int dma, int stream) {
+    struct dma_stream_reg_map *s = &dma_base[dma]->stream[stream];
+    s->CR &= ~DMA_SxCR_EN;
+    MMIO_WRITTEN(s->CR);
+    while (s->CR & DMA_SxCR_EN) {};
+}
+
+/**
+ * @brief  Returns NDTR, the number of items the stream has not moved yet.
+ */
+uint16_t dma_stream_remaining(int dma, int stream) {
+    return dma_base[dma]->stream[stream].NDTR;
+}
+
+/**
+ * @brief  Returns the flags of a stream shifted down to the DMA_*IF positions.
+ */
+uint32_t dma_get_flags(int dma, int stream) {
+    struct dma_reg_map *d = dma_base[dma];
+    uint32_t isr = (stream < 4) ? d->LISR : d->HISR;
+    return (isr >> dma_flag_shift[stream & 3]) & DMA_ALL_FLAGS;
+}
+
+/**
+ * @brief  Clears the given DMA_*IF flags of a stream (write 1 to clear).
+ */
+void dma_clear_flags(int dma, int stream, uint32_t flags) {
+    struct dma_reg_map *d = dma_base[dma];
+    uint32_t mask = (flags & DMA_ALL_FLAGS) << dma_flag_shift[stream & 3];
+    if (stream < 4) {
+        d->LIFCR = mask;
+        MMIO_WRITTEN(d->LIFCR);
+    } else {
+        d->HIFCR = mask;
+        MMIO_WRITTEN(d->HIFCR);
+    }
+}
@@ -15,8 +15,13 @@
 #include <exti.h>
 #include <gpio.h>
 #include <unistd.h>
+#include <string.h>
 #include <nvic.h>
+#include <timer.h>
+#include <mmio.h>
 #include <arm.h>
+#include <trace.h>
+#include <log.h>
 
 #define YUHONG
 #ifdef YUHONG
@@ -25,115 +30,460 @@
 #include "gpio_pin_yiying.h"
 #endif
 
+/* TIM1 counts the edges where the board has the pins for it, unless ENCODER=exti */
+#if defined(ENC_TIMER) && !defined(ENCODER_EXTI)
+#define ENCODER_TIMER
+#endif
+
 /** @brief encoder's states */
 typedef enum {S00 = 0x0, S10 = 0x2, S11 = 0x3, S01 = 0x1} encoder_state;
 
+/** @brief ENC_STAMP_TIMER runs at the undivided 16 MHz timer clock */
+#define ENC_STAMP_HZ        (configCPU_CLOCK_HZ)
+#define ENC_STAMP_MS        (ENC_STAMP_HZ / 1000)
+/** @brief shortest M/T window; a 10 ms control loop closes one every call */
+#define ENC_VEL_WINDOW      (5 * ENC_STAMP_MS)
+/** @brief edges per window below which 1/T is used alone, and above which M/T is */
+#define ENC_VEL_M_LOW       (2)
+#define ENC_VEL_M_HIGH      (8)
+/** @brief no edge for this long reads as standing still */
+#define ENC_VEL_STOP        (100 * ENC_STAMP_MS)
+
+/** @brief EXTI lines, and the ones with a vector in boot.S (not 1 to 3) */
+#define ENC_EXTI_LINES      (16)
+#define ENC_EXTI_VECTORED   (0xFFF1)
+
+/*
+ * Position change for (last_state << 2) | state. Forward is S00, S01, S11,
+ * S10; a step across the square (S00 <-> S11, S01 <-> S10) is 0 here and
+ * a bit in ENC_ILLEGAL.
+ */
+static const int8_t enc_delta[16] = {
+     0, +1, -1,  0,
+    -1,  0,  0, +1,
+    +1,  0,  0, -1,
+     0, -1, +1,  0,
+};
+#define ENC_ILLEGAL ((1 << 0x3) | (1 << 0x6) | (1 << 0x9) | (1 << 0xC))
+
+/*
+ * Everything an encoder's interrupts publish is written between two
+ * increments of its seq, so it is odd while a write is under way. Readers
+ * copy, then retry if seq was odd or moved meanwhile: they never mask
+ * interrupts and never see half of a 64-bit value, and the ISR never waits.
+ *
+ * turns is the multi-turn position in ticks. The EXTI backend keeps all of
+ * it there; the timer backend keeps whole revolutions, counted on the
+ * timer's update interrupt, and adds CNT when read.
+ *
+ * The edge log for the velocity estimate is written once per edge: the
+ * stamp of the last edge, and the stamp ticks between the last two if they
+ * went the same way (0 after a reversal).
+ */
+static encoder_t encoders[ENCODER_MAX];
+
+/*
+ * EXTI dispatch: the encoder on each line, and the lines that have one.
+ * encoder_create fills the table before it sets the mask, and
+ * encoder_delete clears the mask first, so a handler that sees a line in
+ * the mask finds its encoder.
+ */
+static encoder_t *volatile exti_encoders[ENC_EXTI_LINES];
+static volatile uint32_t exti_lines;
+
+/** @brief the encoder on the timer backend, if any */
+static encoder_t *volatile timer_encoder;
+/** @brief the one encoder_init made, the one TRACE=1 sees */
+static encoder_t *board_encoder;
+
 /**
- * @brief  Initializes the GPIO pins for the encoder (ENC A and ENC B), and configures associated EXTI interrupts
- * 
+ * @brief  the free-running edge timestamp clock
+ *
 */
-void encoder_init() {
-    gpio_init(ENC_A_PORT, ENC_A_PIN, MODE_INPUT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_UP, ALT0);
-    gpio_init(ENC_B_PORT, ENC_B_PIN, MODE_INPUT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_UP, ALT0);
+static inline uint32_t encoder_stamp(void) {
+    struct tim2_5 *tim = timer_base[ENC_STAMP_TIMER];
+    MMIO_READ(tim->cnt);
+    return tim->cnt;
+}
 
-    enable_exti(ENC_A_PORT, ENC_A_PIN, RISING_FALLING_EDGE);
-    enable_exti(ENC_B_PORT, ENC_B_PIN, RISING_FALLING_EDGE);
+/**
+ * @brief  log delta edges seen at stamp; more than one only from the timer
+ *         backend, whose edges are noticed when polled
+ *
+*/
+static void encoder_edge(encoder_t *enc, int32_t delta, uint32_t stamp) {
+    int32_t dir = (delta > 0) - (delta < 0);
+    uint32_t steps = (uint32_t)(delta * dir);
+    enc->vel_period = (dir == enc->vel_dir) ? (stamp - enc->vel_stamp) / steps : 0;
+    enc->vel_dir = dir;
+    enc->vel_stamp = stamp;
 }
 
 /**
- * @brief  Disables the EXTIs for the two encoder pins.
- * 
+ * @brief  open / close a write of the published state, from an ISR
+ *
 */
-void encoder_stop() {
-    disable_exti(ENC_A_PIN);
-    disable_exti(ENC_B_PIN);
+static inline void encoder_write_begin(encoder_t *enc) {
+    enc->seq++;
+    dmb();
 }
 
-/** @brief encoder's position */
-volatile uint32_t enc_pos = 0;
-/** @brief last state of the encoder */
-volatile uint32_t last_state = S00;
+static inline void encoder_write_end(encoder_t *enc) {
+    dmb();
+    enc->seq++;
+}
+
+/**
+ * @brief  the multi-turn position, consistent with enc->seq == seq
+ *
+*/
+static inline int64_t encoder_position(encoder_t *enc) {
+    if (enc->timer == 0) {
+        return enc->turns;
+    }
+    struct tim2_5 *tim = timer_base[enc->timer];
+    uint32_t uif, cnt;
+    do {
+        uif = tim->sr & TIM_SR_UIF;
+        cnt = tim->cnt;
+    } while ((tim->sr & TIM_SR_UIF) != uif);
+    // a wrap the update interrupt has not counted yet: CNT tells which way
+    int64_t turns = enc->turns;
+    if (uif) {
+        turns += (cnt < enc->ticks_per_rev / 2) ? (int64_t)enc->ticks_per_rev : -(int64_t)enc->ticks_per_rev;
+    }
+    return turns + cnt;
+}
 
 /**
  * @brief  updating the position based on the state transition observed
- * 
+ *
 */
-void encoder_irq_handler() {
-    uint32_t enc_a = gpio_read(ENC_A_PORT, ENC_A_PIN);
-    uint32_t enc_b = gpio_read(ENC_B_PORT, ENC_B_PIN);
-    encoder_state enc_state = (encoder_state)((enc_a << 1) | (enc_b));
-
-    switch (last_state)
-    {
-    case S00:
-        if (enc_state == S01) {
-            enc_pos++;
-            if (enc_pos >= TICKS_PER_REV) {
-                enc_pos = 0;
-            }
-        } else if (enc_state == S10) {
-            if (enc_pos == 0) {
-                enc_pos = TICKS_PER_REV - 1;
-            } else {
-                enc_pos--;
-            }
-        }
-        break;
-    case S01:
-        if (enc_state == S11) {
-            enc_pos++;
-            if (enc_pos >= TICKS_PER_REV) {
-                enc_pos = 0;
-            }
-        } else if (enc_state == S00) {
-            if (enc_pos == 0) {
-                enc_pos = TICKS_PER_REV - 1;
-            } else {
-                enc_pos--;
-            }
+static void encoder_decode(encoder_t *enc) {
+    uint32_t stamp = encoder_stamp();
+    uint32_t idr_a = gpio_read_port(enc->port_a);
+    uint32_t idr_b = (enc->port_b == enc->port_a) ? idr_a : gpio_read_port(enc->port_b);
+    uint32_t enc_state = (((idr_a >> enc->pin_a) & 1) << 1) | ((idr_b >> enc->pin_b) & 1);
+    uint32_t step = (enc->last_state << 2) | enc_state;
+    if (enc == board_encoder) {
+        trace_record(TRACE_ENCODER, enc_state);
+    }
+
+    enc->illegal += (ENC_ILLEGAL >> step) & 1;
+    enc->last_state = enc_state;
+    if (enc_delta[step] != 0) {
+        encoder_write_begin(enc);
+        enc->turns += enc_delta[step];
+        encoder_edge(enc, enc_delta[step], stamp);
+        encoder_write_end(enc);
+    }
+}
+
+/**
+ * @brief  Decodes every encoder with a line pending, once, and clears its
+ *         lines first so an edge during the decode pends again
+ *
+*/
+void encoder_exti_dispatch(uint32_t pending) {
+    pending &= exti_lines;
+    while (pending) {
+        encoder_t *enc = exti_encoders[__builtin_ctz(pending)];
+        pending &= ~enc->lines;
+        exti_clear_pending_bit(enc->pin_a);
+        exti_clear_pending_bit(enc->pin_b);
+        encoder_decode(enc);
+    }
+}
+
+/**
+ * @brief  TIM1 update: CNT wrapped past 0 / ticks_per_rev - 1, one revolution
+ *         more or less. Used in boot.S.
+ *
+*/
+void tim1_up_irq_handler() {
+    encoder_t *enc = timer_encoder;
+    struct tim2_5 *tim = timer_base[1];
+    if (tim->sr & TIM_SR_UIF) {
+        tim->sr &= ~TIM_SR_UIF;
+        if (enc == NULL) {
+            return;
         }
-        break;
-    case S10:
-        if (enc_state == S00) {
-            enc_pos++;
-            if (enc_pos >= TICKS_PER_REV) {
-                enc_pos = 0;
-            }
-        } else if (enc_state == S11) {
-            if (enc_pos == 0) {
-                enc_pos = TICKS_PER_REV - 1;
-            } else {
-                enc_pos--;
-            }
+        int64_t turn = (tim->cnt < enc->ticks_per_rev / 2) ? (int64_t)enc->ticks_per_rev : -(int64_t)enc->ticks_per_rev;
+        encoder_write_begin(enc);
+        enc->turns += turn;
+        encoder_write_end(enc);
+    }
+}
+
+/**
+ * @brief  Hands B / A to the timer as CH1 / CH2 and starts it in encoder mode;
+ *         forward (B leading A) counts up, like the EXTI decoder
+ *
+*/
+static void encoder_start_timer(encoder_t *enc) {
+#ifdef ENCODER_TIMER
+    gpio_init(enc->port_a, enc->pin_a, MODE_ALT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_UP, ENC_TIMER_ALT);
+    gpio_init(enc->port_b, enc->pin_b, MODE_ALT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_UP, ENC_TIMER_ALT);
+
+    timer_start_encoder(enc->timer, enc->ticks_per_rev);
+    timer_base[enc->timer]->sr &= ~TIM_SR_UIF;
+    timer_encoder = enc;
+    timer_base[enc->timer]->dier |= TIM_DIER_UIE;
+    nvic_irq(TIM1_UP_INT_NUM, IRQ_ENABLE);
+#else
+    (void)enc;
+#endif
+}
+
+/**
+ * @brief  Samples the pins as they are and routes their EXTI lines to enc
+ *
+*/
+static void encoder_start_exti(encoder_t *enc) {
+    gpio_init(enc->port_a, enc->pin_a, MODE_INPUT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_UP, ALT0);
+    gpio_init(enc->port_b, enc->pin_b, MODE_INPUT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_UP, ALT0);
+    enc->last_state = (gpio_read(enc->port_a, enc->pin_a) << 1) | gpio_read(enc->port_b, enc->pin_b);
+
+    exti_encoders[enc->pin_a] = enc;
+    exti_encoders[enc->pin_b] = enc;
+    exti_lines |= enc->lines;
+    enable_exti(enc->port_a, enc->pin_a, RISING_FALLING_EDGE);
+    enable_exti(enc->port_b, enc->pin_b, RISING_FALLING_EDGE);
+}
+
+/**
+ * @brief  Takes a free encoder from the pool and starts it; on TIM1 where
+ *         the pins are the board's ENC_TIMER pins and TIM1 is free, on EXTI
+ *         otherwise
+ *
+*/
+encoder_t *encoder_create(gpio_port port_a, uint32_t pin_a, gpio_port port_b, uint32_t pin_b, uint32_t ticks_per_rev) {
+    if (pin_a >= ENC_EXTI_LINES || pin_b >= ENC_EXTI_LINES || pin_a == pin_b || ticks_per_rev == 0) {
+        return NULL;
+    }
+    encoder_t *enc = NULL;
+    for (int i = 0; i < ENCODER_MAX; i++) {
+        if (encoders[i].ticks_per_rev == 0) {
+            enc = &encoders[i];
+            break;
         }
-        break;
-    case S11:
-        if (enc_state == S10) {
-            enc_pos++;
-            if (enc_pos >= TICKS_PER_REV) {
-                enc_pos = 0;
-            }
-        } else if (enc_state == S01) {
-            if (enc_pos == 0) {
-                enc_pos = TICKS_PER_REV - 1;
-            } else {
-                enc_pos--;
-            }
+    }
+    if (enc == NULL) {
+        return NULL;
+    }
+
+    int timer = 0;
+#ifdef ENCODER_TIMER
+    if (timer_encoder == NULL && port_a == ENC_A_PORT && pin_a == ENC_A_PIN &&
+        port_b == ENC_B_PORT && pin_b == ENC_B_PIN) {
+        timer = ENC_TIMER;
+    }
+#endif
+    uint32_t lines = (1 << pin_a) | (1 << pin_b);
+    if (timer == 0 && ((lines & ~ENC_EXTI_VECTORED) || (lines & exti_lines))) {
+        return NULL;
+    }
+
+    memset(enc, 0, sizeof(*enc));
+    enc->port_a = port_a;
+    enc->pin_a = pin_a;
+    enc->port_b = port_b;
+    enc->pin_b = pin_b;
+    enc->ticks_per_rev = ticks_per_rev;
+    enc->timer = timer;
+    enc->lines = timer ? 0 : lines;
+
+    // shared by all encoders, never stopped
+    static int stamp_started;
+    if (!stamp_started) {
+        timer_start_counter(ENC_STAMP_TIMER, 1);
+        stamp_started = 1;
+    }
+    enc->vel_stamp = encoder_stamp();
+    if (timer) {
+        encoder_start_timer(enc);
+    } else {
+        encoder_start_exti(enc);
+    }
+    return enc;
+}
+
+/**
+ * @brief  Stops enc and gives it back to the pool. Not from an ISR.
+ *
+*/
+void encoder_delete(encoder_t *enc) {
+    if (enc == NULL || enc->ticks_per_rev == 0) {
+        return;
+    }
+    if (enc->timer) {
+        nvic_irq(TIM1_UP_INT_NUM, IRQ_DISABLE);
+        timer_disable(enc->timer);
+        timer_encoder = NULL;
+    } else {
+        disable_exti(enc->pin_a);
+        disable_exti(enc->pin_b);
+        exti_lines &= ~enc->lines;
+        exti_encoders[enc->pin_a] = NULL;
+        exti_encoders[enc->pin_b] = NULL;
+    }
+    if (enc == board_encoder) {
+        board_encoder = NULL;
+    }
+    enc->ticks_per_rev = 0;
+}
+
+/**
+ * @brief  Returns the signed multi-turn position in ticks since encoder_create.
+ *
+*/
+int64_t encoder_turns(encoder_t *enc) {
+    uint32_t seq;
+    int64_t pos;
+    do {
+        seq = enc->seq;
+        dmb();
+        pos = encoder_position(enc);
+        dmb();
+    } while ((seq & 1) || seq != enc->seq);
+    return pos;
+}
+
+/**
+ * @brief  Returns the position within the revolution.
+ *
+*/
+uint32_t encoder_ticks(encoder_t *enc) {
+    int64_t pos = encoder_turns(enc) % enc->ticks_per_rev;
+    return (uint32_t)((pos < 0) ? pos + enc->ticks_per_rev : pos);
+}
+
+/**
+ * @brief  Returns the signed velocity in ticks per second, forward positive.
+ *         1/T (one edge period, stretched while no edge comes) is exact at
+ *         low speed; M/T (edges over the time between the first and last
+ *         of a window) at high speed. The two blend linearly between
+ *         ENC_VEL_M_LOW and ENC_VEL_M_HIGH edges per window.
+ *
+*/
+float encoder_velocity(encoder_t *enc) {
+    uint32_t now = encoder_stamp();
+    uint32_t seq, stamp, period;
+    int64_t count;
+    int32_t dir;
+    do {
+        seq = enc->seq;
+        dmb();
+        count = encoder_position(enc);
+        stamp = enc->vel_stamp;
+        period = enc->vel_period;
+        dir = enc->vel_dir;
+        dmb();
+    } while ((seq & 1) || seq != enc->seq);
+    // the caller's share of the state is updated with every interrupt masked:
+    // the timer backend's edge log has the update IRQ as its other writer,
+    // and several tasks may call this
+    uint32_t primask = irq_save();
+    if (enc->timer) {
+        // no interrupt per edge: the edges since the last call are dated now
+        count = encoder_position(enc);
+        if (count != enc->polled) {
+            encoder_write_begin(enc);
+            encoder_edge(enc, (int32_t)(count - enc->polled), now);
+            enc->polled = count;
+            encoder_write_end(enc);
         }
-        break;
-    default:
-        break;
+        stamp = enc->vel_stamp;
+        period = enc->vel_period;
+        dir = enc->vel_dir;
+    }
+
+    if (now - enc->win_start >= ENC_VEL_WINDOW) {
+        int32_t m = (int32_t)(count - enc->win_count);
+        enc->win_rate = (m != 0 && stamp != enc->win_stamp) ? (float)m * ENC_STAMP_HZ / (float)(stamp - enc->win_stamp) : 0.0f;
+        enc->win_edges = (uint32_t)((m < 0) ? -m : m);
+        enc->win_count = count;
+        enc->win_stamp = stamp;
+        enc->win_start = now;
+    }
+    uint32_t win_edges = enc->win_edges;
+    float win_rate = enc->win_rate;
+    irq_restore(primask);
+
+    float period_rate = 0.0f;
+    uint32_t since = now - stamp;
+    if (period != 0 && since < ENC_VEL_STOP) {
+        period_rate = (float)dir * ENC_STAMP_HZ / (float)((since > period) ? since : period);
     }
-    last_state = enc_state;
+
+    float alpha = (float)((int32_t)win_edges - ENC_VEL_M_LOW) / (ENC_VEL_M_HIGH - ENC_VEL_M_LOW);
+    alpha = (alpha < 0.0f) ? 0.0f : (alpha > 1.0f) ? 1.0f : alpha;
+    return alpha * win_rate + (1.0f - alpha) * period_rate;
+}
+
+encoder_t *encoder_default() {
+    return board_encoder;
+}
+
+/**
+ * @brief  Initializes the board's encoder on ENC A and ENC B
+ *
+*/
+void encoder_init() {
+    encoder_delete(board_encoder);
+    board_encoder = encoder_create(ENC_A_PORT, ENC_A_PIN, ENC_B_PORT, ENC_B_PIN, TICKS_PER_REV);
+    if (board_encoder == NULL) {
+        // the wrappers below read 0 from here on
+        LOG("encoder_init: ENC A / ENC B are taken\n");
+    }
+}
+
+/**
+ * @brief  Stops the board's encoder.
+ *
+*/
+void encoder_stop() {
+    encoder_delete(board_encoder);
+}
+
+/**
+ * @brief  Decodes the board's encoder now, as its EXTI would. Nothing on the
+ *         timer backend, whose turns only holds whole revolutions, or when
+ *         there is no board encoder.
+ *
+*/
+void encoder_irq_handler() {
+    if (board_encoder == NULL || board_encoder->timer != 0) {
+        return;
+    }
+    encoder_decode(board_encoder);
 }
 
 /**
  * @brief  Returns the current position of the motor.
- * 
+ *
 */
 uint32_t encoder_read() {
-    taskENTER_CRITICAL();
-    uint32_t pos = enc_pos;
-    taskEXIT_CRITICAL();
-    return pos;
+    if (board_encoder == NULL) {
+        return 0;
+    }
+    return encoder_ticks(board_encoder);
+}
+
+/**
+ * @brief  Returns the signed multi-turn position in ticks since encoder_init.
+ *
+*/
+int64_t encoder_read_position() {
+    if (board_encoder == NULL) {
+        return 0;
+    }
+    return encoder_turns(board_encoder);
+}
+
+float encoder_read_velocity() {
+    if (board_encoder == NULL) {
+        return 0.0f;
+    }
+    return encoder_velocity(board_encoder);
 }
@@ -14,6 +14,8 @@
 #include <stdio.h>
 #include <encoder.h>
 #include <arm.h>
+#include <mmio.h>
+#include <trace.h>
 
 /** @brief define unused */
 #define UNUSED __attribute__((unused))
@@ -37,10 +39,10 @@
 #define EXTI_PR6    (1 << 6)
 /** @brief EXTI_PR7 */
 #define EXTI_PR7    (1 << 7)
-/** @brief EXTI_PR8 */
-#define EXTI_PR8    (1 << 8)
-/** @brief EXTI_PR9 */
-#define EXTI_PR9    (1 << 9)
+/** @brief lines sharing EXTI9_5 */
+#define EXTI_PR9_5      (0x03E0)
+/** @brief lines sharing EXTI15_10 */
+#define EXTI_PR15_10    (0xFC00)
 
 /** @brief EXTI0_INT_NUM */
 #define EXTI0_INT_NUM (6)
@@ -169,43 +171,46 @@ void exti_clear_pending_bit(UNUSED uint32_t channel) {
     struct exti_reg_map* exti = EXTI_BASE;
     // cleared by programming it to ‘1’.
     exti->pr = (1 << channel);
+    MMIO_WRITTEN(exti->pr);
 }
 
 /**
  * @brief  EXTI9_5 Interrupt Handler: used in boot.S
+ *         Encoders first: a line an encoder owns is cleared before the buttons look.
  *
 */
 void EXTI9_5_IRQHandler(void) {
     struct exti_reg_map* exti = EXTI_BASE;
 
-    // For YIYING's encoder
-    // if (exti->pr & (EXTI_PR5 | EXTI_PR6)) { 
-    //     encoder_irq_handler();
-    //     exti_clear_pending_bit(5);
-    //     exti_clear_pending_bit(6);
-    // }
+    encoder_exti_dispatch(exti->pr & EXTI_PR9_5);
 
     if (exti->pr & EXTI_PR7) {      // forward button
         exti_flag_forward = 1;
+        trace_record(TRACE_BUTTON, 7);
         exti_clear_pending_bit(7);
     }
 
     if (exti->pr & EXTI_PR6) {      // backword button
         exti_flag_backward = 1;
+        trace_record(TRACE_BUTTON, 6);
         exti_clear_pending_bit(6);
     }
 
-    // For YUHONG's encoder
-    if (exti->pr & (EXTI_PR8 | EXTI_PR9)) {
-        encoder_irq_handler();
-        
-        exti_clear_pending_bit(8);
-        exti_clear_pending_bit(9);
-    }
-
     nvic_clear_pending(EXTI9_5_INT_NUM);
 }
 
+/**
+ * @brief  EXTI15_10 Interrupt Handler: used in boot.S
+ *         Encoders only
+ *
+*/
+void EXTI15_10_IRQHandler(void) {
+    struct exti_reg_map* exti = EXTI_BASE;
+
+    encoder_exti_dispatch(exti->pr & EXTI_PR15_10);
+    nvic_clear_pending(EXTI15_10_INT_NUM);
+}
+
 /**
  * @brief  EXTI0 Interrupt Handler: used in boot.S
  *         FOR YIYING's forward button
@@ -214,8 +219,10 @@ void EXTI0_IRQHandler(void) {
     // breakpoint();
     struct exti_reg_map* exti = EXTI_BASE;
     // For YIYING's LED toggle, boot.s: .word   EXTI0_IRQHandler                /* 22 IRQ6 EXTI0 */
+    encoder_exti_dispatch(exti->pr & EXTI_PR0);
     if (exti->pr & EXTI_PR0) { 
         exti_flag_forward = 1;
+        trace_record(TRACE_BUTTON, 0);
         exti_clear_pending_bit(0);
     }
     
@@ -231,8 +238,10 @@ void EXTI4_IRQHandler(void){
     // breakpoint();
     struct exti_reg_map* exti = EXTI_BASE;
     // For YIYING's LED toggle, boot.s: .word   EXTI4_IRQHandler                /* 26 IRQ6 EXTI4 */
+    encoder_exti_dispatch(exti->pr & EXTI_PR4);
     if (exti->pr & EXTI_PR4){
         exti_flag_backward = 1;
+        trace_record(TRACE_BUTTON, 4);
         exti_clear_pending_bit(4);
     }
     // breakpoint();
@@ -1,5 +1,6 @@
 #include <gpio.h>
 #include <rcc.h>
+#include <mmio.h>
 
 #define BITS_PER_ALT 4
 #define BITS_PER_MODE 2
@@ -11,15 +12,15 @@
 
 /** @brief GPIO Registers - A through G */
 typedef struct{
-    volatile unsigned long mode;    /**< 0 - Mode */
-    volatile unsigned long o_type;  /**< 4 - Output Type */
-    volatile unsigned long o_speed; /**< 8 - Output Speed */
-    volatile unsigned long pu_pd;   /**< C - Pull-Up/Pull-Down */
-    volatile unsigned long idr;     /**< 10 - Input Data */
-    volatile unsigned long odr;     /**< 14 - Output Data*/
-    volatile unsigned long bsrr;    /**< 18 - Set/Reset */
-    volatile unsigned long lckr;    /**< 1C - Configuration Lock */
-    volatile unsigned long afr[2];  /**< 20 - Alternate Function Control*/
+    volatile uint32_t mode;         /**< 0 - Mode */
+    volatile uint32_t o_type;       /**< 4 - Output Type */
+    volatile uint32_t o_speed;      /**< 8 - Output Speed */
+    volatile uint32_t pu_pd;        /**< C - Pull-Up/Pull-Down */
+    volatile uint32_t idr;          /**< 10 - Input Data */
+    volatile uint32_t odr;          /**< 14 - Output Data*/
+    volatile uint32_t bsrr;         /**< 18 - Set/Reset */
+    volatile uint32_t lckr;         /**< 1C - Configuration Lock */
+    volatile uint32_t afr[2];       /**< 20 - Alternate Function Control*/
 } gpio_reg;
 
 /* Bitmask to enable IO Port (A - E) */
@@ -60,6 +61,7 @@ void gpio_init(gpio_port port, unsigned int num, unsigned int mode, unsigned int
  */
 void gpio_set(gpio_port port, unsigned int num){
     gpio_regs[port]->bsrr = 1 << num;           /* Writing to bits 0-15 of BSRR sets the GPIO pin */
+    MMIO_WRITTEN(gpio_regs[port]->bsrr);
 }
 
 /*
@@ -67,6 +69,7 @@ void gpio_set(gpio_port port, unsigned int num){
  */
 void gpio_clr(gpio_port port, unsigned int num){
     gpio_regs[port]->bsrr = 1 << (num + 16);    /* Writing to bits 16-31 of BSRR clears the GPIO pin */
+    MMIO_WRITTEN(gpio_regs[port]->bsrr);
 }
 
 /*
@@ -74,4 +77,11 @@ void gpio_clr(gpio_port port, unsigned int num){
  */
 int gpio_read(gpio_port port, unsigned int num) {
     return !!(gpio_regs[port]->idr & (1 << num));
+}
+
+/*
+ * gpio_read_port: Read all 16 pins of a port with one IDR load.
+ */
+uint32_t gpio_read_port(gpio_port port) {
+    return gpio_regs[port]->idr;
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <i2c.h>
 #include <unistd.h>
 #include <rcc.h>
+#include <mmio.h>
 
 
 /** @brief The i2c register map. */
@@ -60,6 +61,31 @@ struct i2c_reg_map {
 /** @brief I2C_SR1_SB bit mask */
 #define I2C_SR1_SB (1)
 
+/** @brief status polls before giving up on the bus, several byte times at
+ *  100 kHz. Without it a missing or wedged slave hangs the caller, and the
+ *  LCD driver polls with interrupts masked. */
+#ifdef HOST_SIM
+// a host spin is a few ns and the bus model moves every 100 us
+#define I2C_TIMEOUT_SPINS (10000000)
+#else
+#define I2C_TIMEOUT_SPINS (10000)
+#endif
+
+/**
+ *
+ * @brief wait until one of the mask bits of reg is set (set = 1) or all are
+ *        clear (set = 0). Returns 0, or -1 on timeout.
+ *
+ */
+static int i2c_wait(volatile uint32_t *reg, uint32_t mask, int set) {
+    for (int spins = 0; spins < I2C_TIMEOUT_SPINS; spins++) {
+        if (((*reg & mask) != 0) == set) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
 /**
  *
  * @brief  initialize the master mode in i2c.
@@ -95,12 +121,14 @@ void i2c_master_init(uint16_t clk){
 int i2c_master_start(){
     struct i2c_reg_map *i2c = I2C1_BASE;
     // First, wait until BUSY bit is cleared
-    while (i2c->SR2 & I2C_SR2_BUSY);
+    if (i2c_wait(&i2c->SR2, I2C_SR2_BUSY, 0) != 0) {
+        return -1;
+    }
     // Then set the START bit to generate the start condition
     i2c->CR1 |= I2C_CR1_START; // Make sure I2C_SB is the correct mask for the START bit in CR1
+    MMIO_WRITTEN(i2c->CR1);
     // Now wait for the SB flag to be set
-    while (!(i2c->SR1 & I2C_SR1_SB));
-    return 0;
+    return i2c_wait(&i2c->SR1, I2C_SR1_SB, 1);
 }
 
 /**
@@ -111,10 +139,11 @@ int i2c_master_start(){
 int i2c_master_stop(){
     struct i2c_reg_map *i2c = I2C1_BASE;
     // check TxE and BTF bit (they should be set to 1)(EV8_2)
-    while (!(i2c->SR1 & I2C_SR1_BTF) && !(i2c-> SR1 & I2C_SR1_TXE));
-    // set stop bit
+    int status = i2c_wait(&i2c->SR1, I2C_SR1_BTF | I2C_SR1_TXE, 1);
+    // set stop bit, on a timeout too, to let go of the bus
     i2c->CR1 |= I2C_CR1_STOP;
-    return 0;
+    MMIO_WRITTEN(i2c->CR1);
+    return status;
 }
 
 /**
@@ -126,28 +155,41 @@ int i2c_master_write(uint8_t *buf, uint16_t len, uint8_t slave_addr){
     struct i2c_reg_map *i2c = I2C1_BASE;
 
     // start condition of the master transmission
-    i2c_master_start();
+    if (i2c_master_start() != 0) {
+        return -1;
+    }
 
     // write the slave address of slave into data register
     i2c->DR = slave_addr; 
+    MMIO_WRITTEN(i2c->DR);
     // wait for ADDR to be set
-    while(!(i2c->SR1 & I2C_SR1_ADDR));  
+    if (i2c_wait(&i2c->SR1, I2C_SR1_ADDR, 1) != 0) {
+        i2c_master_stop();
+        return -1;
+    }
     // Clear ADDR by reading SR2
     (void)i2c->SR2;
+    MMIO_READ(i2c->SR2);
 
     // write buf into data register
     for(int i = 0; i < len; i++){
         // Wait for TxE to be set
-        while (!(i2c->SR1 & I2C_SR1_TXE));
+        if (i2c_wait(&i2c->SR1, I2C_SR1_TXE, 1) != 0) {
+            i2c_master_stop();
+            return -1;
+        }
         // Send data byte
         i2c->DR = buf[i];
+        MMIO_WRITTEN(i2c->DR);
     }
     
     // Wait for BTF to be set before issuing stop condition
-    while (!(i2c->SR1 & I2C_SR1_BTF));
+    int status = i2c_wait(&i2c->SR1, I2C_SR1_BTF, 1);
     // Send stop condition
-    i2c_master_stop();
-    return 0;
+    if (i2c_master_stop() != 0) {
+        status = -1;
+    }
+    return status;
 }
 
 /**
@@ -0,0 +1,201 @@
+/**
+ * @file isrprof.c
+ *
+ * @brief Per-IRQ execution time and entry latency through a RAM vector table
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <isrprof.h>
+
+#ifdef ISR_PROFILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+#include <arm.h>
+#include <dwt.h>
+#include <mmio.h>
+#include <timer.h>
+
+/** @brief SCB vector table offset register */
+#define SCB_VTOR        (volatile uint32_t *) 0xE000ED08
+/** @brief system exceptions ahead of IRQ0 */
+#define VECTOR_IRQ0     (16)
+#define VECTORS         (VECTOR_IRQ0 + ISRPROF_IRQS)
+
+/** @brief one IRQ's numbers */
+typedef struct {
+    uint32_t runs;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t depth;
+    uint32_t lat_runs;
+    uint32_t lat_min;
+    uint32_t lat_max;
+    uint64_t lat_sum;
+} isrprof_stats_t;
+
+/** @brief the table VTOR points at; aligned to its size rounded up to 2^n */
+static uint32_t ram_vectors[VECTORS] __attribute__((aligned(512)));
+/** @brief the handlers the boot table had */
+static uint32_t handlers[ISRPROF_IRQS];
+
+static isrprof_stats_t stats[ISRPROF_IRQS];
+
+/** @brief handlers running now; 0 in thread mode */
+static volatile uint32_t depth;
+/** @brief per level, cycles taken by the handlers that preempted it */
+static volatile uint32_t preempted[ISRPROF_DEPTH + 1];
+
+/** @brief names in the dump, for the IRQs the firmware uses */
+static const char *const irq_names[ISRPROF_IRQS] = {
+    [6] = "EXTI0",
+    [7] = "EXTI1",
+    [10] = "EXTI4",
+    [16] = "DMA1_Stream5",
+    [17] = "DMA1_Stream6",
+    [23] = "EXTI9_5",
+    [25] = "TIM1_UP_TIM10",
+    [28] = "TIM2",
+    [29] = "TIM3",
+    [30] = "TIM4",
+    [38] = "USART2",
+    [40] = "EXTI15_10",
+    [50] = "TIM5",
+};
+
+/**
+ * @brief  cycles since the update event that pended a timer's IRQ, from
+ *         where its counter got to; -1 if irq is not a pending update
+ *
+*/
+static int64_t isrprof_latency(uint32_t irq) {
+    int timer;
+    switch (irq) {
+        case TIM2_INT_NUM: timer = 2; break;
+        case TIM3_INT_NUM: timer = 3; break;
+        case TIM4_INT_NUM: timer = 4; break;
+        case TIM5_INT_NUM: timer = 5; break;
+        default: return -1;
+    }
+    struct tim2_5 *tim = timer_base[timer];
+    if (!(tim->sr & TIM_SR_UIF)) {
+        return -1;
+    }
+    // up-counting from 0 since the update; the timer clock is the CPU clock
+    MMIO_READ(tim->cnt);
+    return (int64_t)tim->cnt * (tim->psc + 1);
+}
+
+/**
+ * @brief  every IRQ comes here: time the handler the boot table had for it.
+ *         A handler that preempts this one finishes before it resumes, so
+ *         depth and the preempted counts unwind like a stack.
+ *
+*/
+static void isrprof_trampoline(void) {
+    uint32_t irq = ipsr() - VECTOR_IRQ0;
+    int64_t latency = isrprof_latency(irq);
+    uint32_t level = depth + 1;
+    uint32_t slot = (level > ISRPROF_DEPTH) ? ISRPROF_DEPTH : level;
+
+    preempted[slot] = 0;
+    depth = level;
+    uint32_t start = dwt_cycles();
+    ((void (*)(void))(uintptr_t)handlers[irq])();
+    uint32_t total = dwt_cycles() - start;
+    uint32_t cycles = total - preempted[slot];
+    depth = level - 1;
+    preempted[slot - 1] += total;
+
+    isrprof_stats_t *s = &stats[irq];
+    s->runs++;
+    s->min = (cycles < s->min) ? cycles : s->min;
+    s->max = (cycles > s->max) ? cycles : s->max;
+    s->sum += cycles;
+    s->depth = (level > s->depth) ? level : s->depth;
+    if (latency >= 0) {
+        uint32_t lat = (latency > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency;
+        s->lat_runs++;
+        s->lat_min = (lat < s->lat_min) ? lat : s->lat_min;
+        s->lat_max = (lat > s->lat_max) ? lat : s->lat_max;
+        s->lat_sum += lat;
+    }
+}
+
+/**
+ * @brief  copy the vector table VTOR points at now, route the IRQs that
+ *         have a handler through the trampoline, and switch over
+ *
+*/
+void isrprof_init(void) {
+    const uint32_t *boot = (const uint32_t *)(uintptr_t)*SCB_VTOR;
+
+    dwt_init();
+    isrprof_clear();
+    for (uint32_t i = 0; i < VECTOR_IRQ0; i++) {
+        ram_vectors[i] = boot[i];
+    }
+    for (uint32_t irq = 0; irq < ISRPROF_IRQS; irq++) {
+        handlers[irq] = boot[VECTOR_IRQ0 + irq];
+        ram_vectors[VECTOR_IRQ0 + irq] = handlers[irq] ? (uint32_t)(uintptr_t)isrprof_trampoline : 0;
+#ifdef PC_PROFILE
+        // pcprof's handler needs EXC_RETURN in lr and the frame the core stacked
+        if (irq == TIM4_INT_NUM) {
+            ram_vectors[VECTOR_IRQ0 + irq] = handlers[irq];
+        }
+#endif
+    }
+    UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    dsb();
+    *SCB_VTOR = (uint32_t)(uintptr_t)ram_vectors;
+    dsb();
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * @brief  under PRIMASK: the EXTI and timer handlers run at priority 0,
+ *         above the kernel's BASEPRI mask, and update stats on their way out
+ *
+*/
+void isrprof_clear(void) {
+    for (uint32_t irq = 0; irq < ISRPROF_IRQS; irq++) {
+        uint32_t primask = irq_save();
+        memset(&stats[irq], 0, sizeof(stats[irq]));
+        stats[irq].min = UINT32_MAX;
+        stats[irq].lat_min = UINT32_MAX;
+        irq_restore(primask);
+    }
+}
+
+/**
+ * @brief  print a consistent copy of each IRQ's numbers; the copy is taken
+ *         with every interrupt masked (PRIMASK), the printing is not
+ *
+*/
+void isrprof_dump(void) {
+    for (uint32_t irq = 0; irq < ISRPROF_IRQS; irq++) {
+        uint32_t primask = irq_save();
+        isrprof_stats_t s = stats[irq];
+        irq_restore(primask);
+        if (s.runs == 0) {
+            continue;
+        }
+        printf("isr,%lu,%s,%lu,%lu,%lu,%lu,%lu,", (unsigned long)irq, irq_names[irq] ? irq_names[irq] : "-",
+               (unsigned long)s.runs, (unsigned long)s.min, (unsigned long)(s.sum / s.runs),
+               (unsigned long)s.max, (unsigned long)s.depth);
+        if (s.lat_runs == 0) {
+            printf("-,-,-\n");
+        } else {
+            printf("%lu,%lu,%lu\n", (unsigned long)s.lat_min, (unsigned long)(s.lat_sum / s.lat_runs),
+                   (unsigned long)s.lat_max);
+        }
+    }
+}
+
+#endif /* ISR_PROFILE */
@@ -3,6 +3,7 @@
 #include <gpio.h>
 #include <keypad_driver.h>
 #include <unistd.h>
+#include <trace.h>
 
 #define YUHONG
 #ifdef YUHONG
@@ -95,6 +96,7 @@ char keypad_read() {
                     // last_debounce = systick_get_ticks();    // update debounce 
                 }
                 gpio_set(col_ports[col], col_pins[col]); // Set column back to HI
+                trace_record(TRACE_KEY, key);
                 return key; // Return the detected key
             }
         }
@@ -0,0 +1,125 @@
+/**
+ * @file log.c
+ *
+ * @brief Deferred-formatting binary logger, drained as telemetry frames
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+#include <string.h>
+#include <arm.h>
+#include <ring_buffer.h>
+#include <telemetry.h>
+#include <log.h>
+
+/** @brief record header in the ring: nargs, fmt id, timestamp */
+#define LOG_HEADER_SIZE     (1 + 4 + 4)
+
+/** @brief storage behind logQueue */
+static uint8_t logStorage[LOG_BUFFER_SIZE];
+/** @brief records from any task or ISR, drained by vLogTask */
+static MpscRingBuffer logQueue;
+/** @brief records lost to a full ring */
+static volatile uint32_t dropped;
+/** @brief vLogTask while it sleeps on an empty ring */
+static TaskHandle_t volatile logWaitingTask;
+
+/**
+ * @brief  wake vLogTask if it is waiting for a record
+ */
+static void log_notify(void) {
+    TaskHandle_t task = logWaitingTask;
+    if (task == NULL) {
+        return;
+    }
+    logWaitingTask = NULL;
+    if (ipsr() != 0) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(task);
+    }
+}
+
+/**
+ * @brief  queue one record with a single reservation, so records from
+ *         different contexts never interleave. Never blocks.
+ */
+void log_record(const char *fmt, const uint32_t *args, uint32_t nargs) {
+    uint8_t rec[LOG_HEADER_SIZE + 4 * LOG_MAX_ARGS];
+    uint32_t id = (uint32_t)(uintptr_t)fmt;
+    uint32_t now = ((ipsr() != 0) ? xTaskGetTickCountFromISR() : xTaskGetTickCount()) * portTICK_PERIOD_MS;
+    uint16_t start;
+
+    if (nargs > LOG_MAX_ARGS) {
+        nargs = LOG_MAX_ARGS;
+    }
+    // the header is packed by hand, the ring is byte oriented
+    rec[0] = (uint8_t)nargs;
+    memcpy(&rec[1], &id, 4);
+    memcpy(&rec[5], &now, 4);
+    memcpy(&rec[LOG_HEADER_SIZE], args, 4 * nargs);
+
+    uint16_t len = LOG_HEADER_SIZE + 4 * nargs;
+    if (MpscRingBuffer_Reserve(&logQueue, len, &start) != 0) {
+        dropped++;
+        return;
+    }
+    MpscRingBuffer_Fill(&logQueue, start, rec, len);
+    MpscRingBuffer_Publish(&logQueue);
+    log_notify();
+}
+
+/**
+ * @brief  drain task: turns each record into a TELEMETRY_FRAME_LOG frame.
+ *         Sleeps until log_record wakes it, so the tasks below the control
+ *         loop that poll instead of blocking cannot starve it; it is the
+ *         one that waits when the UART queue is full. The waiter is
+ *         registered before the emptiness re-check so a record landing in
+ *         between is not missed.
+ */
+static void vLogTask(void *pvParameters) {
+    (void)pvParameters;
+    uint8_t rec[LOG_HEADER_SIZE + 4 * LOG_MAX_ARGS];
+
+    for (;;) {
+        if (RingBuffer_isEmpty(&logQueue.rb)) {
+            logWaitingTask = xTaskGetCurrentTaskHandle();
+            if (RingBuffer_isEmpty(&logQueue.rb)) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            logWaitingTask = NULL;
+            continue;
+        }
+        // records are published whole, so the header implies the rest is there
+        uint8_t nargs;
+        RingBuffer_Read(&logQueue.rb, (char *)&nargs);
+        uint16_t len = LOG_HEADER_SIZE - 1 + 4 * nargs;
+        RingBuffer_ReadBlock(&logQueue.rb, rec, len);
+
+        telemetry_send_wait(TELEMETRY_FRAME_LOG, rec, len);
+    }
+}
+
+/** @brief set up the ring and start the drain task */
+void log_init(void) {
+    MpscRingBuffer_init(&logQueue, logStorage, LOG_BUFFER_SIZE);
+    xTaskCreate(
+        vLogTask,
+        "Log",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY + 1,
+        NULL);
+}
+
+/** @brief records lost to a full ring since boot */
+uint32_t log_dropped(void) {
+    return dropped;
+}
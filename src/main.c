@@ -28,6 +28,14 @@
 #include <exti.h>
 #include <encoder.h>
 #include <motor_driver.h>
+#include <atcmd.h>
+#include <telemetry.h>
+#include <log.h>
+#include <dwt.h>
+#include <pid.h>
+#include <trace.h>
+#include <isrprof.h>
+#include <pcprof.h>
 
 /** @brief define gpio pin header file */
 #define YUHONG
@@ -41,10 +49,6 @@
 int g_passcode = 349;
 /** @brief define dutycycle */
 volatile int g_dutycycle = 16;
-/** @brief define highest motor speed */
-#define MAX_MOTOR_SPEED 90
-/** @brief define lowest motor speed */
-#define MIN_MOTOR_SPEED 10
 
 /** @brief servo's states (degree) */
 #define DEGREE_0 0
@@ -82,6 +86,155 @@ void vBlinkyTask(void *pvParameters) {
     }
 }
 
+/**
+ * @brief  AT+BAUD=<rate>: acknowledge at the current rate, then switch.
+ *         The host moves to the new rate once it has seen "OK".
+ *
+*/
+static uint8_t atcmd_baud(void *args, const char *cmdargs) {
+    (void)args;
+    if (cmdargs == NULL) {
+        return 0;
+    }
+    int baud = atoi(cmdargs);
+    if (uart_check_baud(baud) != 0) {
+        return 0;
+    }
+    write(STDOUT_FILENO, "OK\r\n", 4);
+    return uart_set_baud(baud) == 0;
+}
+
+/** @brief snprintf calls timed by AT+FMTBENCH */
+#define FMT_BENCH_RUNS          (100)
+/** @brief stack of the benchmark task, roomy enough for newlib's vfprintf */
+#define FMT_BENCH_STACK_WORDS   (512)
+/** @brief which printf the image was built with, see PRINTF in the Makefile */
+#ifdef PRINTF_NEWLIB
+#define PRINTF_IMPL "newlib"
+#else
+#define PRINTF_IMPL "tiny"
+#endif
+
+/**
+ * @brief  time FMT_BENCH_RUNS LCD-style snprintf calls in a fresh task and
+ *         report cycles and stack use as one CSV line:
+ *         fmtbench,<impl>,<runs>,<min>,<mean>,<max>,<stack bytes>
+ *
+*/
+static void vFmtBenchTask(void *pvParameters) {
+    (void)pvParameters;
+    char line[40];
+    uint32_t min = UINT32_MAX, max = 0, sum = 0;
+
+    dwt_init();
+    for (int i = 0; i < FMT_BENCH_RUNS; i++) {
+        float gain = 2.81f + i * 0.01f;
+        uint32_t start = dwt_cycles();
+        snprintf(line, sizeof(line), "P-%.2f %5d %lx", gain, i, (unsigned long)start);
+        uint32_t cycles = dwt_cycles() - start;
+        min = (cycles < min) ? cycles : min;
+        max = (cycles > max) ? cycles : max;
+        sum += cycles;
+    }
+    uint32_t stack = (FMT_BENCH_STACK_WORDS - uxTaskGetStackHighWaterMark(NULL)) * sizeof(StackType_t);
+    printf("fmtbench,%s,%d,%lu,%lu,%lu,%lu\n", PRINTF_IMPL, FMT_BENCH_RUNS,
+           (unsigned long)min, (unsigned long)(sum / FMT_BENCH_RUNS), (unsigned long)max, (unsigned long)stack);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief  AT+FMTBENCH: run the formatter benchmark; build with PRINTF=newlib
+ *         and PRINTF=tiny and compare, `make size` gives the flash side.
+ *
+*/
+static uint8_t atcmd_fmtbench(void *args, const char *cmdargs) {
+    (void)args;
+    (void)cmdargs;
+    return xTaskCreate(vFmtBenchTask, "FmtBench", FMT_BENCH_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS;
+}
+
+/**
+ * @brief  AT+STATS: print the UART error and backpressure counters
+ *
+*/
+static uint8_t atcmd_stats(void *args, const char *cmdargs) {
+    (void)args;
+    (void)cmdargs;
+    uart_stats_t stats;
+    uart_get_stats(&stats);
+    printf("ore=%lu fe=%lu nf=%lu rx_drop=%lu rx_peak=%u rts=%lu tx_drop=%lu\n",
+           (unsigned long)stats.overrun, (unsigned long)stats.framing, (unsigned long)stats.noise,
+           (unsigned long)stats.rx_dropped, stats.rx_peak, (unsigned long)stats.rx_throttled,
+           (unsigned long)stats.tx_dropped);
+    encoder_t *enc = encoder_default();
+    printf("enc_illegal=%lu\n", (unsigned long)(enc ? enc->illegal : 0));
+    return 1;
+}
+
+#ifdef TRACE
+/**
+ * @brief  AT+TRACE: print the input trace; AT+TRACE=CLEAR starts it over
+ *
+*/
+static uint8_t atcmd_trace(void *args, const char *cmdargs) {
+    (void)args;
+    if (cmdargs != NULL && strcmp(cmdargs, "CLEAR") == 0) {
+        trace_init();
+    } else {
+        trace_dump();
+    }
+    return 1;
+}
+#endif
+
+#ifdef ISR_PROFILE
+/**
+ * @brief  AT+ISRPROF: print the per-IRQ timings; AT+ISRPROF=CLEAR starts over
+ *
+*/
+static uint8_t atcmd_isrprof(void *args, const char *cmdargs) {
+    (void)args;
+    if (cmdargs != NULL && strcmp(cmdargs, "CLEAR") == 0) {
+        isrprof_clear();
+    } else {
+        isrprof_dump();
+    }
+    return 1;
+}
+#endif
+
+#ifdef PC_PROFILE
+/**
+ * @brief  AT+PCPROF: print the PC histogram; AT+PCPROF=CLEAR starts over
+ *
+*/
+static uint8_t atcmd_pcprof(void *args, const char *cmdargs) {
+    (void)args;
+    if (cmdargs != NULL && strcmp(cmdargs, "CLEAR") == 0) {
+        pcprof_clear();
+    } else {
+        pcprof_dump();
+    }
+    return 1;
+}
+#endif
+
+/** @brief AT commands accepted on the console */
+static const atcmd_t atcmds[] = {
+    {"BAUD", atcmd_baud, NULL},
+    {"FMTBENCH", atcmd_fmtbench, NULL},
+    {"STATS", atcmd_stats, NULL},
+#ifdef TRACE
+    {"TRACE", atcmd_trace, NULL},
+#endif
+#ifdef ISR_PROFILE
+    {"ISRPROF", atcmd_isrprof, NULL},
+#endif
+#ifdef PC_PROFILE
+    {"PCPROF", atcmd_pcprof, NULL},
+#endif
+};
+
 /**
  * @brief  handle the UART echo task
  *
@@ -89,6 +242,8 @@ void vBlinkyTask(void *pvParameters) {
 static void vUARTEchoTask(void *pvParameters) {
     (void)pvParameters;
     char buffer[100];
+    atcmd_parser_t parser;
+    atcmd_parser_init(&parser, atcmds, sizeof(atcmds) / sizeof(atcmds[0]));
     
     for (;;) {
         // only work when command mode
@@ -108,6 +263,9 @@ static void vUARTEchoTask(void *pvParameters) {
                         break; // Stop at the first newline/carriage return character
                     }
                 }
+                if (buffer[0] != '\0') {
+                    atcmd_parse(&parser, buffer);
+                }
             }
         }
         vTaskDelay(pdMS_TO_TICKS(100));
@@ -144,81 +302,21 @@ void vExtiTask(void* pvParameters) {
             exti_flag_backward = 0; // Clear the interrupt flag
             // Decrement 200 encoder position safely
             target_position = (target_position - 200 + MAX_POS) % (MAX_POS);
-            printf("Target_position = %ld\n", target_position);
+            LOG("Target_position = %lu\n", target_position);
         }
         // FORWARD
         if (exti_flag_forward) {
             exti_flag_forward = 0; // Clear the interrupt flag
             target_position = (target_position + 200) % (MAX_POS);
-            printf("Target_position = %ld\n", target_position);
+            LOG("Target_position = %lu\n", target_position);
         }
         vTaskDelay(pdMS_TO_TICKS(250)); // Delay to debounce the button
     }
 }
 
-/**
- * @brief  handle encoder task
- *
-*/
-void vEncoderMonitorTask(void* pvParameters) {
-    (void)pvParameters;
-    uint32_t motor_pos = 0;
-    while(1) {
-        motor_pos = encoder_read();
-        printf("Motor_position = %ld\n", motor_pos);
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-}
-
-/** @brief PID parameters */
-typedef struct {
-    /** @brief PID parameters */
-    float P;
-    /** @brief PID parameters */
-    float I;
-    /** @brief PID parameters */
-    float D;
-    /** @brief PID parameters */
-    float integrator;
-    /** @brief PID parameters */
-    float prevError;
-    /** @brief PID parameters */
-    SemaphoreHandle_t mutex;
-} PIDParameters;
-
 /** @brief init PID parameters */
 volatile PIDParameters pidParams = {2.81f, 0.38f, 0.09f, 0.0f, 0.0f, NULL};
 
-/** @brief pid update function with simple algorithm */
-float UpdatePID(PIDParameters *pid, int error, float deltaTime) {
-    float pTerm, iTerm, dTerm;
-    xSemaphoreTake(pid->mutex, portMAX_DELAY);
-    // proportional term calculation
-    pTerm = pid->P * error;
-    // Intergral term calculation 
-    pid->integrator += error * deltaTime;
-    iTerm = pid->I * pid->integrator;
-    // derivative term
-    dTerm = pid->D * (error - pid->prevError) / deltaTime;
-
-    pid->prevError = error;
-    xSemaphoreGive(pid->mutex);
-    float output = pTerm + iTerm + dTerm;
-    return output;
-}
-
-/** @brief helper function of floating point abs val */
-float absoluteValue(float x) {
-    return (x < 0) ? -x : x;
-}
-
-/** @brief helper function of better path */
-int32_t findBestPath(uint32_t current_pos, uint32_t target_pos) {
-    int32_t forward_path = (target_pos - current_pos + TICKS_PER_REV) % TICKS_PER_REV;
-    int32_t backward_path = (current_pos - target_pos + TICKS_PER_REV) % TICKS_PER_REV;
-    return (forward_path <= backward_path) ? forward_path : -backward_path;
-}
-
 /**
  * @brief PID controller task
  *
@@ -295,19 +393,22 @@ void motorControlTask(void* pvParameters) {
     (void)pvParameters;
     while (1) {
         uint32_t curr_pos = encoder_read();
-        int32_t error = findBestPath(curr_pos, target_position);
-        float pid_output = UpdatePID((PIDParameters *)&pidParams, error, 0.01f);   // delta time is 1ms
-        // printf("pid_out = %f\n", pid_output);
-        MotorDirection direction = pid_output >= 0 ? FORWARD : BACKWARD;
-        uint32_t motor_speed = absoluteValue(pid_output);
-
-        if (motor_speed > MAX_MOTOR_SPEED) {
-            motor_speed = MAX_MOTOR_SPEED;
-        } else if (motor_speed < MIN_MOTOR_SPEED) {
-            motor_speed = MIN_MOTOR_SPEED;
-        }
+        int32_t error;
+        int32_t duty = pid_control_step((PIDParameters *)&pidParams, curr_pos, target_position, 0.01f, &error);   // delta time is 10ms
+        MotorDirection direction = (duty >= 0) ? FORWARD : BACKWARD;
+        uint32_t motor_speed = abs(duty);
 
         motor_set_dir(MORTO_IN1_PORT, MORTO_IN2_PORT, MORTO_IN1_PIN, MORTO_IN2_PIN, PWM_TIMER, PWM_TIMER_CHANNEL, motor_speed, direction);
+
+        // one binary sample per iteration replaces the old 10 Hz "Motor_position" text
+        telemetry_sample_t sample = {
+            .timestamp = xTaskGetTickCount() * portTICK_PERIOD_MS,
+            .position = (int32_t)curr_pos,
+            .target = (int32_t)target_position,
+            .error = error,
+            .pwm = (int16_t)duty,
+        };
+        telemetry_send_sample(&sample);
     
         vTaskDelay(pdMS_TO_TICKS(10));
     }
@@ -372,7 +473,10 @@ void vServoTask(void *pvParameters) {
  *
 */
 int main( void ) {
+    trace_init();
+    isrprof_init();
     uart_init(115200);
+    log_init();
     keypad_init();
     i2c_master_init(80);
     pidParams.mutex = xSemaphoreCreateMutex();
@@ -418,14 +522,6 @@ int main( void ) {
         tskIDLE_PRIORITY + 1,
         NULL);
     
-    xTaskCreate(
-        vEncoderMonitorTask, 
-        "EnocderMonitor", 
-        configMINIMAL_STACK_SIZE, 
-        NULL, 
-        tskIDLE_PRIORITY + 1, 
-        NULL);
-
     xTaskCreate(
         vServoTask, 
         "Servo", 
@@ -434,6 +530,7 @@ int main( void ) {
         tskIDLE_PRIORITY + 1, 
         NULL);
 
+    pcprof_init();
     vTaskStartScheduler();
     
     // Infinite loop
@@ -8,6 +8,7 @@
  */
 
 #include <nvic.h>
+#include <mmio.h>
 
 void nvic_irq( uint8_t irq_num, uint8_t status ) {
   uint8_t shift_num = irq_num % NVIC_REG_SIZE;
@@ -24,7 +25,10 @@ void nvic_irq( uint8_t irq_num, uint8_t status ) {
     return;
   }
 
-  nvic->reg[reg_num] |= ( 0x1 << shift_num );
+  // ISER / ICER are write-1: a read-modify-write would also act on every
+  // other IRQ that reads back as enabled
+  nvic->reg[reg_num] = ( 0x1 << shift_num );
+  MMIO_WRITTEN( nvic->reg[reg_num] );
 
   return;
 }
@@ -34,5 +38,26 @@ void nvic_clear_pending( uint8_t irq_num ) {
   uint8_t reg_num = irq_num / NVIC_REG_SIZE;
   struct nvic_t *nvic = NVIC_ICPR_BASE;
 
-  nvic->reg[reg_num] |= ( 0x1 << shift_num );
+  nvic->reg[reg_num] = ( 0x1 << shift_num );
+  MMIO_WRITTEN( nvic->reg[reg_num] );
+}
+
+/* Pends irq from software: if it is enabled and its priority allows, the
+ * handler runs before the next instruction after the write. */
+void nvic_set_pending( uint8_t irq_num ) {
+  uint8_t shift_num = irq_num % NVIC_REG_SIZE;
+  uint8_t reg_num = irq_num / NVIC_REG_SIZE;
+  struct nvic_t *nvic = NVIC_ISPR_BASE;
+
+  nvic->reg[reg_num] = ( 0x1 << shift_num );
+  MMIO_WRITTEN( nvic->reg[reg_num] );
+}
+
+/* Priorities live in the upper NVIC_PRIO_BITS of each byte; IRQs that call
+ * FreeRTOS FromISR APIs must sit at or below
+ * configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY (numerically >=). */
+void nvic_set_priority( uint8_t irq_num, uint8_t priority ) {
+  volatile uint8_t *ipr = NVIC_IPR_BASE;
+
+  ipr[irq_num] = ( uint8_t )( priority << NVIC_PRIO_SHIFT );
 }
\ No newline at end of file
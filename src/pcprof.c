@@ -0,0 +1,180 @@
+/**
+ * @file pcprof.c
+ *
+ * @brief Statistical profiler: TIM4 samples the interrupted PC and task
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <pcprof.h>
+
+#ifdef PC_PROFILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+#include <arm.h>
+#include <nvic.h>
+#include <timer.h>
+
+/** @brief words of the exception frame ahead of the stacked PC: r0-r3, r12, lr */
+#define FRAME_PC            (6)
+/** @brief EXC_RETURN bit 3: the exception preempted thread mode */
+#define EXC_RETURN_THREAD   (1 << 3)
+
+/** @brief the timer clock (16 MHz HSI) down to 1 MHz */
+#define PCPROF_PRESCALER    (16)
+#define PCPROF_TIMER        (4)
+
+#ifdef HOST_SIM
+/* the host linker's names for the bounds of the code */
+extern char __executable_start[], etext[];
+#define TEXT_START          ((uint32_t)(uintptr_t)__executable_start)
+#define TEXT_END            ((uint32_t)(uintptr_t)etext)
+#else
+/* util/linker_template.lds */
+extern char _stext[], _etext[];
+#define TEXT_START          ((uint32_t)(uintptr_t)_stext)
+#define TEXT_END            ((uint32_t)(uintptr_t)_etext)
+#endif
+
+/** @brief samples per task; NULL counts main() before the scheduler runs */
+typedef struct {
+    TaskHandle_t task;
+    uint32_t count;
+} pcprof_task_t;
+
+static uint32_t buckets[PCPROF_BUCKETS];
+static pcprof_task_t tasks[PCPROF_TASKS];
+static uint32_t task_count;
+/** @brief samples that preempted another handler */
+static uint32_t isr_samples;
+/** @brief samples whose PC was outside .text */
+static uint32_t other_samples;
+static uint32_t samples;
+/** @brief log2 of the bytes per bucket */
+static uint32_t shift;
+
+void pcprof_sample(const uint32_t *frame, uint32_t exc_return);
+
+/**
+ * @brief  count one sample: the PC the preempted code stacked, and who ran it
+ *
+*/
+void pcprof_sample(const uint32_t *frame, uint32_t exc_return) {
+    timer_clear_interrupt_bit(PCPROF_TIMER);
+
+    uint32_t offset = frame[FRAME_PC] - TEXT_START;
+    if (frame[FRAME_PC] >= TEXT_START && offset < TEXT_END - TEXT_START) {
+        buckets[offset >> shift]++;
+    } else {
+        other_samples++;
+    }
+    samples++;
+
+    if (!(exc_return & EXC_RETURN_THREAD)) {
+        isr_samples++;
+        return;
+    }
+    // plain reads of the kernel's state, safe above the syscall priority
+    TaskHandle_t task = NULL;
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+    for (uint32_t i = 0; i < task_count; i++) {
+        if (tasks[i].task == task) {
+            tasks[i].count++;
+            return;
+        }
+    }
+    if (task_count < PCPROF_TASKS) {
+        tasks[task_count].task = task;
+        tasks[task_count].count = 1;
+        task_count++;
+    }
+}
+
+#ifdef HOST_SIM
+/**
+ * @brief  TIM4 vector: the simulated core has no stack frames, it hands over
+ *         the interrupted PC in arm_frame (see arm.h); tasks are in thread mode
+ *
+*/
+void tim4_irq_handler(void) {
+    pcprof_sample((const uint32_t *)arm_frame, 0xFFFFFFFD);
+}
+#else
+/**
+ * @brief  TIM4 vector: EXC_RETURN bit 2 says whether the hardware stacked the
+ *         frame on the process (task) or the main stack
+ *
+*/
+__attribute__((naked)) void tim4_irq_handler(void) {
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "mov r1, lr\n"
+        "b pcprof_sample\n"
+    );
+}
+#endif
+
+/**
+ * @brief  size the buckets to .text, clear them and start TIM4
+ *
+*/
+void pcprof_init(void) {
+    shift = 1;
+    while (((TEXT_END - TEXT_START) >> shift) >= PCPROF_BUCKETS) {
+        shift++;
+    }
+    pcprof_clear();
+    timer_init(PCPROF_TIMER, PCPROF_PRESCALER, PCPROF_PERIOD_US);
+}
+
+void pcprof_clear(void) {
+    nvic_irq(TIM4_INT_NUM, IRQ_DISABLE);
+    memset(buckets, 0, sizeof(buckets));
+    memset(tasks, 0, sizeof(tasks));
+    task_count = 0;
+    isr_samples = 0;
+    other_samples = 0;
+    samples = 0;
+    nvic_irq(TIM4_INT_NUM, IRQ_ENABLE);
+}
+
+/**
+ * @brief  print the histogram. TIM4 sits above the interrupt mask, so it is
+ *         stopped for the dump instead; samples are lost meanwhile.
+ *
+*/
+void pcprof_dump(void) {
+    nvic_irq(TIM4_INT_NUM, IRQ_DISABLE);
+    printf("pcprof,hz,%lu,samples,%lu,base,0x%08lx,shift,%lu\n", (unsigned long)PCPROF_HZ,
+           (unsigned long)samples, (unsigned long)TEXT_START, (unsigned long)shift);
+    for (uint32_t i = 0; i < task_count; i++) {
+        printf("pcprof,task,%s,%lu\n", tasks[i].task ? pcTaskGetName(tasks[i].task) : "main",
+               (unsigned long)tasks[i].count);
+    }
+    if (isr_samples) {
+        printf("pcprof,task,isr,%lu\n", (unsigned long)isr_samples);
+    }
+    for (uint32_t i = 0; i < PCPROF_BUCKETS; i++) {
+        if (buckets[i]) {
+            printf("pcprof,pc,0x%08lx,%lu\n", (unsigned long)(TEXT_START + (i << shift)),
+                   (unsigned long)buckets[i]);
+        }
+    }
+    if (other_samples) {
+        printf("pcprof,pc,0,%lu\n", (unsigned long)other_samples);
+    }
+    printf("pcprof,end\n");
+    nvic_irq(TIM4_INT_NUM, IRQ_ENABLE);
+}
+
+#endif /* PC_PROFILE */
@@ -0,0 +1,56 @@
+/**
+ * @file pid.c
+ *
+ * @brief Motor Controller: the PID update and the path to the target
+ *
+ * @date 04/16/2024
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <pid.h>
+#include <encoder.h>
+
+/** @brief pid update function with simple algorithm */
+float UpdatePID(PIDParameters *pid, int error, float deltaTime) {
+    float pTerm, iTerm, dTerm;
+    xSemaphoreTake(pid->mutex, portMAX_DELAY);
+    // proportional term calculation
+    pTerm = pid->P * error;
+    // Intergral term calculation 
+    pid->integrator += error * deltaTime;
+    iTerm = pid->I * pid->integrator;
+    // derivative term
+    dTerm = pid->D * (error - pid->prevError) / deltaTime;
+
+    pid->prevError = error;
+    xSemaphoreGive(pid->mutex);
+    float output = pTerm + iTerm + dTerm;
+    return output;
+}
+
+/** @brief helper function of better path */
+int32_t findBestPath(uint32_t current_pos, uint32_t target_pos) {
+    int32_t forward_path = (target_pos - current_pos + TICKS_PER_REV) % TICKS_PER_REV;
+    int32_t backward_path = (current_pos - target_pos + TICKS_PER_REV) % TICKS_PER_REV;
+    return (forward_path <= backward_path) ? forward_path : -backward_path;
+}
+
+/** @brief helper function of floating point abs val */
+static float absoluteValue(float x) {
+    return (x < 0) ? -x : x;
+}
+
+/** @brief one step of the position loop, as motorControlTask runs it */
+int32_t pid_control_step(PIDParameters *pid, uint32_t curr_pos, uint32_t target_pos, float deltaTime, int32_t *error) {
+    *error = findBestPath(curr_pos, target_pos);
+    float pid_output = UpdatePID(pid, *error, deltaTime);
+    uint32_t motor_speed = absoluteValue(pid_output);
+
+    if (motor_speed > MAX_MOTOR_SPEED) {
+        motor_speed = MAX_MOTOR_SPEED;
+    } else if (motor_speed < MIN_MOTOR_SPEED) {
+        motor_speed = MIN_MOTOR_SPEED;
+    }
+    return (pid_output >= 0) ? (int32_t)motor_speed : -(int32_t)motor_speed;
+}
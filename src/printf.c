@@ -0,0 +1,416 @@
+/**
+ * @file printf.c
+ *
+ * @brief Small reentrant printf family that replaces newlib's vfprintf
+ *
+ * Supports %d %i %u %x %X %o %c %s %p %f %F and %%, with the - + space # 0
+ * flags, width and precision (both may be *), and the hh h l ll z j t
+ * length modifiers. %e and %g are printed like %f. Floats are split into
+ * an integer part and a fraction scaled by 10^precision (at most 9 digits),
+ * so no dtoa, no malloc and no per-task FILE state; stack use is bounded
+ * by PRINTF_LINE_MAX plus a few dozen bytes. Ties round away from zero in
+ * double precision, so the last digit can differ from newlib's exact
+ * round-half-even (2.5 -> "3", 0.95 -> "1.0").
+ *
+ * printf / vprintf / puts / putchar go straight to uart_write, one call
+ * per line of up to PRINTF_LINE_MAX bytes, so lines from different tasks
+ * stay whole. Built instead of newlib's versions unless PRINTF=newlib.
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <stdarg.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <uart.h>
+
+/** @brief printf stages this many bytes on the stack per uart_write */
+#ifndef PRINTF_LINE_MAX
+#define PRINTF_LINE_MAX     (80)
+#endif
+
+/** @brief most fraction digits %f prints */
+#define PRINTF_FLOAT_PREC_MAX   (9)
+
+/** @brief conversion flags */
+#define FMT_LEFT    (1 << 0)
+#define FMT_PLUS    (1 << 1)
+#define FMT_SPACE   (1 << 2)
+#define FMT_ALT     (1 << 3)
+#define FMT_ZERO    (1 << 4)
+#define FMT_UPPER   (1 << 5)
+
+/** @brief one parsed conversion specification */
+typedef struct {
+    int flags;
+    int width;
+    /** @brief -1 when not given */
+    int prec;
+} fmt_spec_t;
+
+/**
+ * @brief output sink: a bounded buffer, flushed to a stream when full
+ *        (printf) or silently truncated (snprintf)
+ */
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t pos;
+    /** @brief characters the call would have produced, the return value */
+    int total;
+    void (*flush)(const char *data, size_t len);
+} fmt_sink_t;
+
+/** @brief powers of ten for the %f fraction */
+static const uint32_t fmt_pow10[PRINTF_FLOAT_PREC_MAX + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/** @brief append one character, flushing or truncating at the end of the buffer */
+static void sink_putc(fmt_sink_t *s, char c) {
+    s->total++;
+    if (s->pos < s->size) {
+        s->buf[s->pos++] = c;
+        if (s->pos == s->size && s->flush != NULL) {
+            s->flush(s->buf, s->pos);
+            s->pos = 0;
+        }
+    }
+}
+
+/** @brief append c n times */
+static void sink_fill(fmt_sink_t *s, char c, int n) {
+    while (n-- > 0) {
+        sink_putc(s, c);
+    }
+}
+
+/** @brief append len bytes of str */
+static void sink_write(fmt_sink_t *s, const char *str, int len) {
+    while (len-- > 0) {
+        sink_putc(s, *str++);
+    }
+}
+
+/**
+ * @brief emit [pad][prefix][zeros][body][pad] for one conversion; zeros is
+ *        the padding the precision asks for, width padding is added here
+ */
+static void fmt_emit(fmt_sink_t *s, const fmt_spec_t *spec, const char *prefix, const char *body, int len, int zeros) {
+    int plen = (int)strlen(prefix);
+    int pad = spec->width - plen - zeros - len;
+
+    if (!(spec->flags & (FMT_LEFT | FMT_ZERO))) {
+        sink_fill(s, ' ', pad);
+    }
+    sink_write(s, prefix, plen);
+    if ((spec->flags & (FMT_LEFT | FMT_ZERO)) == FMT_ZERO) {
+        sink_fill(s, '0', pad);
+    }
+    sink_fill(s, '0', zeros);
+    sink_write(s, body, len);
+    if (spec->flags & FMT_LEFT) {
+        sink_fill(s, ' ', pad);
+    }
+}
+
+/**
+ * @brief digits of v in base, written backwards from end; returns the first.
+ *        Values that fit 32 bits avoid the 64-bit division helper.
+ */
+static char *fmt_digits(char *end, uint64_t v, unsigned base, int upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *p = end;
+
+    while (v > UINT32_MAX) {
+        *--p = digits[v % base];
+        v /= base;
+    }
+    uint32_t v32 = (uint32_t)v;
+    do {
+        *--p = digits[v32 % base];
+        v32 /= base;
+    } while (v32 != 0);
+    return p;
+}
+
+/** @brief sign character for a conversion, "" when there is none */
+static const char *fmt_sign(const fmt_spec_t *spec, int negative) {
+    if (negative) {
+        return "-";
+    }
+    if (spec->flags & FMT_PLUS) {
+        return "+";
+    }
+    return (spec->flags & FMT_SPACE) ? " " : "";
+}
+
+/** @brief integer conversions */
+static void fmt_integer(fmt_sink_t *s, fmt_spec_t *spec, uint64_t v, int negative, unsigned base) {
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+    const char *prefix = fmt_sign(spec, negative);
+
+    // "%.0d" of zero prints nothing
+    if (!(v == 0 && spec->prec == 0)) {
+        p = fmt_digits(end, v, base, spec->flags & FMT_UPPER);
+    }
+    if ((spec->flags & FMT_ALT) && v != 0) {
+        if (base == 16) {
+            prefix = (spec->flags & FMT_UPPER) ? "0X" : "0x";
+        } else if (base == 8) {
+            *--p = '0';
+        }
+    }
+    int len = (int)(end - p);
+    int zeros = 0;
+    if (spec->prec >= 0) {
+        zeros = (spec->prec > len) ? spec->prec - len : 0;
+        spec->flags &= ~FMT_ZERO;
+    }
+    fmt_emit(s, spec, prefix, p, len, zeros);
+}
+
+/** @brief %f: integer part and a fraction rounded to at most 9 digits */
+static void fmt_float(fmt_sink_t *s, fmt_spec_t *spec, double x) {
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+    int negative = (x < 0);
+    int prec = (spec->prec < 0) ? 6 : spec->prec;
+
+    if (negative) {
+        x = -x;
+    }
+    if (x != x || x > 1.8e19) {
+        // NaN, infinity or beyond the 64-bit integer part
+        spec->flags &= ~FMT_ZERO;
+        fmt_emit(s, spec, fmt_sign(spec, negative && x == x), (x != x) ? "nan" : "inf", 3, 0);
+        return;
+    }
+    if (prec > PRINTF_FLOAT_PREC_MAX) {
+        prec = PRINTF_FLOAT_PREC_MAX;
+    }
+
+    uint64_t ipart = (uint64_t)x;
+    uint32_t frac = (uint32_t)((x - (double)ipart) * fmt_pow10[prec] + 0.5);
+    if (frac >= fmt_pow10[prec]) {
+        frac -= fmt_pow10[prec];
+        ipart++;
+    }
+
+    for (int i = 0; i < prec; i++) {
+        *--p = '0' + frac % 10;
+        frac /= 10;
+    }
+    if (prec > 0 || (spec->flags & FMT_ALT)) {
+        *--p = '.';
+    }
+    p = fmt_digits(p, ipart, 10, 0);
+    fmt_emit(s, spec, fmt_sign(spec, negative), p, (int)(end - p), 0);
+}
+
+/** @brief the formatter behind every entry point */
+static int fmt_format(fmt_sink_t *s, const char *fmt, va_list ap) {
+    while (*fmt != '\0') {
+        if (*fmt != '%') {
+            sink_putc(s, *fmt++);
+            continue;
+        }
+        const char *start = fmt++;
+        fmt_spec_t spec = { 0, 0, -1 };
+
+        // flags
+        for (;; fmt++) {
+            if (*fmt == '-') spec.flags |= FMT_LEFT;
+            else if (*fmt == '+') spec.flags |= FMT_PLUS;
+            else if (*fmt == ' ') spec.flags |= FMT_SPACE;
+            else if (*fmt == '#') spec.flags |= FMT_ALT;
+            else if (*fmt == '0') spec.flags |= FMT_ZERO;
+            else break;
+        }
+        // width
+        if (*fmt == '*') {
+            spec.width = va_arg(ap, int);
+            if (spec.width < 0) {
+                spec.flags |= FMT_LEFT;
+                spec.width = -spec.width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') {
+                spec.width = spec.width * 10 + (*fmt++ - '0');
+            }
+        }
+        // precision
+        if (*fmt == '.') {
+            fmt++;
+            spec.prec = 0;
+            if (*fmt == '*') {
+                spec.prec = va_arg(ap, int);
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9') {
+                    spec.prec = spec.prec * 10 + (*fmt++ - '0');
+                }
+            }
+        }
+        // length, counted in how many 'l's / 'h's were seen
+        int lng = 0;
+        int shrt = 0;
+        for (;; fmt++) {
+            if (*fmt == 'l') lng++;
+            else if (*fmt == 'h') shrt++;
+            else if (*fmt == 'z' || *fmt == 't') lng = (sizeof(size_t) > sizeof(int)) ? 1 : 0;
+            else if (*fmt == 'j') lng = 2;
+            else break;
+        }
+
+        char c = *fmt++;
+        switch (c) {
+        case 'd':
+        case 'i': {
+            int64_t v;
+            if (lng >= 2) v = va_arg(ap, long long);
+            else if (lng == 1) v = va_arg(ap, long);
+            else v = va_arg(ap, int);
+            if (shrt == 1) v = (short)v;
+            else if (shrt >= 2) v = (signed char)v;
+            fmt_integer(s, &spec, (v < 0) ? -(uint64_t)v : (uint64_t)v, v < 0, 10);
+            break;
+        }
+        case 'X':
+            spec.flags |= FMT_UPPER;
+            /* fall through */
+        case 'u':
+        case 'x':
+        case 'o': {
+            uint64_t v;
+            if (lng >= 2) v = va_arg(ap, unsigned long long);
+            else if (lng == 1) v = va_arg(ap, unsigned long);
+            else v = va_arg(ap, unsigned int);
+            if (shrt == 1) v = (unsigned short)v;
+            else if (shrt >= 2) v = (unsigned char)v;
+            spec.flags &= ~(FMT_PLUS | FMT_SPACE);
+            fmt_integer(s, &spec, v, 0, (c == 'u') ? 10 : (c == 'o') ? 8 : 16);
+            break;
+        }
+        case 'p':
+            spec.flags = (spec.flags | FMT_ALT) & ~(FMT_PLUS | FMT_SPACE);
+            fmt_integer(s, &spec, (uintptr_t)va_arg(ap, void *), 0, 16);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            fmt_float(s, &spec, va_arg(ap, double));
+            break;
+        case 'c': {
+            char ch = (char)va_arg(ap, int);
+            spec.flags &= ~FMT_ZERO;
+            fmt_emit(s, &spec, "", &ch, 1, 0);
+            break;
+        }
+        case 's': {
+            const char *str = va_arg(ap, const char *);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            int len = 0;
+            while (str[len] != '\0' && (spec.prec < 0 || len < spec.prec)) {
+                len++;
+            }
+            spec.flags &= ~FMT_ZERO;
+            fmt_emit(s, &spec, "", str, len, 0);
+            break;
+        }
+        case '%':
+            sink_putc(s, '%');
+            break;
+        default:
+            // unknown conversion: print it as written
+            if (c == '\0') {
+                fmt--;
+            }
+            sink_write(s, start, (int)(fmt - start));
+            break;
+        }
+    }
+    return s->total;
+}
+
+/** @brief flush callback of the printf sink */
+static void fmt_uart_flush(const char *data, size_t len) {
+    uart_write(STDOUT_FILENO, (char *)data, (int)len);
+}
+
+/** @brief format into buf, at most size bytes including the terminator */
+int vsnprintf(char *buf, size_t size, const char *fmt, va_list ap) {
+    fmt_sink_t s = { buf, (size > 0) ? size - 1 : 0, 0, 0, NULL };
+    int n = fmt_format(&s, fmt, ap);
+    if (size > 0) {
+        buf[s.pos] = '\0';
+    }
+    return n;
+}
+
+/** @brief format into buf, at most size bytes including the terminator */
+int snprintf(char *buf, size_t size, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/** @brief format into buf with no bound, kept for newlib compatibility */
+int sprintf(char *buf, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, INT_MAX, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/** @brief format to the console, one uart_write per PRINTF_LINE_MAX bytes */
+int vprintf(const char *fmt, va_list ap) {
+    char line[PRINTF_LINE_MAX];
+    fmt_sink_t s = { line, sizeof(line), 0, 0, fmt_uart_flush };
+    int n = fmt_format(&s, fmt, ap);
+    if (s.pos > 0) {
+        fmt_uart_flush(line, s.pos);
+    }
+    return n;
+}
+
+/** @brief format to the console */
+int printf(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/** @brief gcc turns printf("...\n") into puts, keep that off newlib stdio too */
+int puts(const char *str) {
+    return printf("%s\n", str);
+}
+
+/* newlib's stdio.h makes putchar a macro over putc(c, stdout) */
+#undef putchar
+
+/** @brief gcc turns printf("%c") into putchar */
+int putchar(int c) {
+    char ch = (char)c;
+    return (uart_write(STDOUT_FILENO, &ch, 1) == 1) ? (unsigned char)ch : EOF;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file ring_buffer.c
+ *
+ * @brief Power-of-two byte ring with block and zero-copy span access
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <ring_buffer.h>
+#include <arm.h>
+
+/** @brief one producer in the high half of MpscRingBuffer.claim */
+#define MPSC_WRITER     (1UL << 16)
+/** @brief reserve counter in the low half of MpscRingBuffer.claim */
+#define MPSC_RESERVED   (0xFFFFUL)
+
+/** @brief attach storage to the ring and mark it empty. */
+int RingBuffer_init(RingBuffer *rb, uint8_t *storage, uint16_t size) {
+    if (size == 0 || (size & (size - 1)) != 0 || size > 0x8000) {
+        return -1;
+    }
+    rb->buffer = storage;
+    rb->size = size;
+    rb->mask = size - 1;
+    rb->head = 0;
+    rb->tail = 0;
+    return 0;
+}
+
+/** @brief number of bytes waiting to be read; counters are free-running so a plain difference works across wrap. */
+uint16_t RingBuffer_used(RingBuffer *rb) {
+    return (uint16_t)(rb->tail - rb->head);
+}
+
+/** @brief number of bytes that can still be written. */
+uint16_t RingBuffer_free(RingBuffer *rb) {
+    return rb->size - RingBuffer_used(rb);
+}
+
+/** @brief check if the ring buffer is empty, if head equal to tail then it can be considered as empty. */
+int RingBuffer_isEmpty(RingBuffer *rb) {
+    return rb->head == rb->tail;
+}
+
+/** @brief check if buffer is full, the counters are exactly one size apart. */
+int RingBuffer_isFull(RingBuffer *rb) {
+    return RingBuffer_used(rb) == rb->size;
+}
+
+/** @brief add a byte to the buffer at tail. */
+int RingBuffer_Write(RingBuffer *rb, char data) {
+    if (RingBuffer_isFull(rb)) {
+        return -1; // Buffer is full
+    }
+    rb->buffer[rb->tail & rb->mask] = data;
+    rb->tail = rb->tail + 1;
+    return 0;
+}
+
+/** @brief read the buffer from head and advance the head. */
+int RingBuffer_Read(RingBuffer *rb, char *data) {
+    if (RingBuffer_isEmpty(rb)) {
+        return -1; // Buffer is empty
+    }
+    *data = rb->buffer[rb->head & rb->mask];
+    rb->head = rb->head + 1;
+    return 0;
+}
+
+/** @brief contiguous free span starting at tail. */
+uint16_t RingBuffer_PeekWrite(RingBuffer *rb, uint8_t **span) {
+    uint16_t idx = rb->tail & rb->mask;
+    uint16_t free = RingBuffer_free(rb);
+    uint16_t to_end = rb->size - idx;
+
+    *span = &rb->buffer[idx];
+    return (free < to_end) ? free : to_end;
+}
+
+/** @brief publish bytes written into the span returned by RingBuffer_PeekWrite. */
+void RingBuffer_CommitWrite(RingBuffer *rb, uint16_t len) {
+    rb->tail = rb->tail + len;
+}
+
+/** @brief contiguous filled span starting at head. */
+uint16_t RingBuffer_PeekRead(RingBuffer *rb, uint8_t **span) {
+    uint16_t idx = rb->head & rb->mask;
+    uint16_t used = RingBuffer_used(rb);
+    uint16_t to_end = rb->size - idx;
+
+    *span = &rb->buffer[idx];
+    return (used < to_end) ? used : to_end;
+}
+
+/** @brief release bytes consumed from the span returned by RingBuffer_PeekRead. */
+void RingBuffer_CommitRead(RingBuffer *rb, uint16_t len) {
+    rb->head = rb->head + len;
+}
+
+/** @brief copy as much of data as fits, in at most two memcpys. */
+uint16_t RingBuffer_WriteBlock(RingBuffer *rb, const void *data, uint16_t len) {
+    const uint8_t *src = data;
+    uint16_t done = 0;
+
+    while (done < len) {
+        uint8_t *span;
+        uint16_t n = RingBuffer_PeekWrite(rb, &span);
+        if (n == 0) {
+            break;
+        }
+        if (n > len - done) {
+            n = len - done;
+        }
+        memcpy(span, src + done, n);
+        RingBuffer_CommitWrite(rb, n);
+        done += n;
+    }
+    return done;
+}
+
+/** @brief copy out up to len bytes, in at most two memcpys. */
+uint16_t RingBuffer_ReadBlock(RingBuffer *rb, void *data, uint16_t len) {
+    uint8_t *dst = data;
+    uint16_t done = 0;
+
+    while (done < len) {
+        uint8_t *span;
+        uint16_t n = RingBuffer_PeekRead(rb, &span);
+        if (n == 0) {
+            break;
+        }
+        if (n > len - done) {
+            n = len - done;
+        }
+        memcpy(dst + done, span, n);
+        RingBuffer_CommitRead(rb, n);
+        done += n;
+    }
+    return done;
+}
+
+/** @brief attach storage to a multi-producer ring and mark it empty. */
+int MpscRingBuffer_init(MpscRingBuffer *q, uint8_t *storage, uint16_t size) {
+    q->claim = 0;
+    return RingBuffer_init(&q->rb, storage, size);
+}
+
+/** @brief space left after everything reserved, published or not. */
+uint16_t MpscRingBuffer_free(MpscRingBuffer *q) {
+    uint16_t reserved = q->claim & MPSC_RESERVED;
+    return q->rb.size - (uint16_t)(reserved - q->rb.head);
+}
+
+/** @brief claim len bytes for one producer, all or nothing. */
+int MpscRingBuffer_Reserve(MpscRingBuffer *q, uint16_t len, uint16_t *start) {
+    uint32_t claim;
+    uint16_t reserved;
+
+    do {
+        claim = ldrex(&q->claim);
+        reserved = claim & MPSC_RESERVED;
+        if ((uint32_t)(uint16_t)(reserved - q->rb.head) + len > q->rb.size) {
+            clrex();
+            return -1;
+        }
+        // bump the writer count and the reserve counter without letting the
+        // counter's wrap carry into the writer count
+    } while (strex(((claim & ~MPSC_RESERVED) + MPSC_WRITER) | (uint16_t)(reserved + len), &q->claim));
+
+    *start = reserved;
+    return 0;
+}
+
+/** @brief copy data into a reserved region, in at most two memcpys. */
+void MpscRingBuffer_Fill(MpscRingBuffer *q, uint16_t start, const void *data, uint16_t len) {
+    uint16_t idx = start & q->rb.mask;
+    uint16_t first = q->rb.size - idx;
+
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&q->rb.buffer[idx], data, first);
+    memcpy(q->rb.buffer, (const uint8_t *)data + first, len - first);
+}
+
+/** @brief finish one producer; the last one out publishes every reserved byte. */
+void MpscRingBuffer_Publish(MpscRingBuffer *q) {
+    uint32_t claim;
+
+    do {
+        claim = ldrex(&q->claim) - MPSC_WRITER;
+    } while (strex(claim, &q->claim));
+
+    if ((claim & ~MPSC_RESERVED) != 0) {
+        return; // someone is still copying, they will publish for us
+    }
+
+    // bytes must land before the consumer can see the new tail
+    dmb();
+    uint16_t end = claim & MPSC_RESERVED;
+    uint16_t tail;
+    do {
+        tail = ldrexh(&q->rb.tail);
+        if ((int16_t)(end - tail) <= 0) {
+            // a later last-writer already published past us
+            clrex();
+            return;
+        }
+    } while (strexh(end, &q->rb.tail));
+}
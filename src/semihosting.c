@@ -0,0 +1,72 @@
+/**
+ * @file   semihosting.c
+ *
+ * @brief  ARM semihosting console, for runs under QEMU or a debugger
+ *
+ * @date   10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <semihosting.h>
+
+#ifdef SEMIHOSTING
+
+#include <stdint.h>
+
+/** @brief semihosting operations, see the ARM semihosting specification */
+#define SYS_OPEN            (0x01)
+#define SYS_WRITE           (0x05)
+#define SYS_EXIT            (0x18)
+#define SYS_EXIT_EXTENDED   (0x20)
+
+/** @brief SYS_OPEN mode "w" */
+#define OPEN_MODE_W         (4)
+/** @brief SYS_EXIT reason for a program that returned normally */
+#define ADP_STOPPED_APPLICATION_EXIT (0x20026)
+
+/** @brief handle of ":tt", the host's console, once opened */
+static int console = -1;
+
+/**
+ * @brief trap into the semihosting host: op in r0, argument block in r1,
+ *        result back in r0
+ */
+static int semihosting_call(int op, void *arg) {
+    register int r0 __asm__("r0") = op;
+    register void *r1 __asm__("r1") = arg;
+    __asm volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+    return r0;
+}
+
+/**
+ * @brief open the console on first use
+ */
+static int semihosting_console(void) {
+    if (console < 0) {
+        uint32_t args[3] = { (uint32_t)(uintptr_t)":tt", OPEN_MODE_W, 3 };
+        console = semihosting_call(SYS_OPEN, args);
+    }
+    return console;
+}
+
+int semihosting_write(const char *buf, int len) {
+    int fd = semihosting_console();
+    if (fd < 0) {
+        return -1;
+    }
+    uint32_t args[3] = { (uint32_t)fd, (uint32_t)(uintptr_t)buf, (uint32_t)len };
+    // the result is the number of bytes NOT written
+    return (semihosting_call(SYS_WRITE, args) == 0) ? 0 : -1;
+}
+
+void semihosting_exit(int status) {
+    uint32_t args[2] = { ADP_STOPPED_APPLICATION_EXIT, (uint32_t)status };
+    semihosting_call(SYS_EXIT_EXTENDED, args);
+    // a host without the extended call still stops, without the status
+    semihosting_call(SYS_EXIT, (void *)ADP_STOPPED_APPLICATION_EXIT);
+    for (;;) {
+    }
+}
+
+#endif /* SEMIHOSTING */
@@ -12,7 +12,7 @@
 #include <gpio.h>
 #include <timer.h>
 #include <nvic.h>
-#include <stdio.h>
+#include <log.h>
 
 /** @brief define gpio pins header file */
 #define YIYING
@@ -170,7 +170,7 @@ void tim3_irq_handler() {
  */
 int servo_enable(UNUSED uint8_t channel, UNUSED uint8_t enabled){
     if (channel != 0 && channel != 1) {
-        printf("Invalid Channel\n");
+        LOG("Invalid Channel\n");
         return -1;
     }
 
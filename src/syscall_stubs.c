@@ -1,8 +1,12 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <reent.h>
 
+#include "FreeRTOS.h"
+#include "task.h"
 #include <uart.h>
+#include <semihosting.h>
 
 /** @brief Built-in file descriptors */
 //@{
@@ -10,6 +14,10 @@
 #define FD_STDOUT   1
 //@}
 
+/** @brief stdio buffer size reported by _fstat; each task that prints gets its
+ *  own stdout buffer from the _sbrk heap, so keep it small */
+#define STDIO_BUFSIZE   (128)
+
 extern char __heap_low;  // Start of the heap
 extern char __heap_top;  // End of the heap (exclusive)
 
@@ -33,6 +41,20 @@ void *_sbrk(int incr) {
     return previous_heap_end; // Return the previous break
 }
 
+/** @brief __malloc_lock keeps newlib's allocator consistent when several
+ *  tasks printf (and so allocate stdio buffers) at once. newlib calls it
+ *  recursively, which scheduler suspension tolerates. */
+void __malloc_lock(struct _reent *r) {
+    (void)r;
+    vTaskSuspendAll();
+}
+
+/** @brief __malloc_unlock releases __malloc_lock */
+void __malloc_unlock(struct _reent *r) {
+    (void)r;
+    (void)xTaskResumeAll();
+}
+
 /** @brief _write allows the user to write things to STDOUT */
 int _write(int file, char *ptr, int len) {
     // call uart write
@@ -48,6 +70,9 @@ int _read(int file, char *ptr, int len) {
 /** @brief _exit exits from the current user program by printing the
  *  status, then going into sleep mode. */
 void _exit(int status) {
+#ifdef SEMIHOSTING
+    semihosting_exit(status);
+#endif
     
     char buffer[50];
     // Format the exit status into the buffer
@@ -70,6 +95,7 @@ int _close(int file) {
 int _fstat(int file, struct stat *st) {
     (void)file;
     st->st_mode = S_IFCHR;
+    st->st_blksize = STDIO_BUFSIZE;
     return 0;
 }
 
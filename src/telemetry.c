@@ -0,0 +1,125 @@
+/**
+ * @file telemetry.c
+ *
+ * @brief COBS + CRC16 framed binary telemetry over the console UART
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <uart.h>
+#include <telemetry.h>
+
+/** @brief type + payload + crc */
+#define TELEMETRY_RAW_MAX       (1 + TELEMETRY_MAX_PAYLOAD + 2)
+/** @brief COBS overhead for TELEMETRY_RAW_MAX plus the delimiter */
+#define TELEMETRY_WIRE_MAX      (TELEMETRY_RAW_MAX + TELEMETRY_RAW_MAX / 254 + 2)
+
+/** @brief frames dropped on a full UART queue */
+static volatile uint32_t dropped;
+
+/** @brief bitwise CRC-16/CCITT, a few bytes per frame do not justify a table */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/** @brief consistent overhead byte stuffing: every 0x00 becomes the distance to the next one */
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst) {
+    size_t code_idx = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != 0) {
+            dst[out++] = src[i];
+            code++;
+        }
+        if (src[i] == 0 || code == 0xFF) {
+            dst[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+        }
+    }
+    dst[code_idx] = code;
+    return out;
+}
+
+/** @brief store v little endian at p, returns the next free byte */
+static uint8_t *put_le(uint8_t *p, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        *p++ = (uint8_t)(v >> (8 * i));
+    }
+    return p;
+}
+
+/** @brief frame and encode one payload into wire, delimiter included; returns its length or 0. */
+static size_t telemetry_encode(uint8_t type, const void *payload, size_t len, uint8_t *wire) {
+    uint8_t raw[TELEMETRY_RAW_MAX];
+
+    if (len > TELEMETRY_MAX_PAYLOAD) {
+        return 0;
+    }
+    raw[0] = type;
+    memcpy(&raw[1], payload, len);
+    uint16_t crc = crc16_ccitt(0xFFFF, raw, len + 1);
+    put_le(&raw[len + 1], crc, 2);
+
+    size_t n = cobs_encode(raw, len + 3, wire);
+    wire[n++] = 0x00;
+    return n;
+}
+
+/** @brief frame, encode and queue one payload; never blocks the caller. */
+int telemetry_send(uint8_t type, const void *payload, size_t len) {
+    uint8_t wire[TELEMETRY_WIRE_MAX];
+    size_t n = telemetry_encode(type, payload, len, wire);
+
+    if (n == 0) {
+        return -1;
+    }
+    // one reservation per frame, so it never interleaves with printf output
+    if (uart_write_nonblock((char *)wire, n) != 0) {
+        dropped++;
+        return -1;
+    }
+    return 0;
+}
+
+/** @brief same as telemetry_send, but waits for room like printf does. */
+int telemetry_send_wait(uint8_t type, const void *payload, size_t len) {
+    uint8_t wire[TELEMETRY_WIRE_MAX];
+    size_t n = telemetry_encode(type, payload, len, wire);
+
+    if (n == 0) {
+        return -1;
+    }
+    return (uart_write(STDOUT_FILENO, (char *)wire, n) == (int)n) ? 0 : -1;
+}
+
+/** @brief pack a sample as 4+4+4+4+2 little-endian bytes and send it. */
+int telemetry_send_sample(const telemetry_sample_t *sample) {
+    uint8_t payload[18];
+    uint8_t *p = payload;
+
+    p = put_le(p, sample->timestamp, 4);
+    p = put_le(p, (uint32_t)sample->position, 4);
+    p = put_le(p, (uint32_t)sample->target, 4);
+    p = put_le(p, (uint32_t)sample->error, 4);
+    p = put_le(p, (uint16_t)sample->pwm, 2);
+    return telemetry_send(TELEMETRY_FRAME_SAMPLE, payload, (size_t)(p - payload));
+}
+
+/** @brief frames lost to a full UART queue since boot. */
+uint32_t telemetry_dropped(void) {
+    return dropped;
+}
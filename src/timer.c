@@ -13,6 +13,7 @@
 #include <rcc.h>
 #include <nvic.h>
 #include <gpio.h>
+#include <mmio.h>
 
 /** @brief define unused */
 #define UNUSED __attribute__((unused))
@@ -38,10 +39,18 @@
 #define TIM_CCER_CC4E (1 << 12)
 /** @brief set TIM_CCER_CC4P */
 #define TIM_CCER_CC4P (1 << 13)
+/** @brief CCMR1 CC1S / CC2S: the channel is an input, mapped on its own TI */
+#define TIM_CCMR_CC1S_TI1 (0b01)
+#define TIM_CCMR_CC2S_TI2 (0b01 << 8)
+/** @brief input filter fCK_INT, N = 4 */
+#define ENC_IC_FILTER (0b0010)
+/** @brief SMCR slave mode select; 011 = encoder mode 3, count on TI1 and TI2 edges */
+#define TIM_SMCR_SMS (0b111)
+#define TIM_SMCR_SMS_ENCODER3 (0b011)
 
 /** @brief set PWM_MODE1 */
 struct tim2_5* const timer_base[] = {(void *)0x0,    // N/A - Don't fill out
-                                     (void *)0x0,    // N/A - Don't fill out
+                                     (void *)0x40010000, // TIMER 1 Base Address, encoder mode only
                                      (void *)0x40000000, // TIMER 2 Base Address
                                      (void *)0x40000400, // TIMER 3 Base Address
                                      (void *)0x40000800, // TIMER 4 Base Address
@@ -157,6 +166,84 @@ void timer_start_pwm(UNUSED int timer, UNUSED uint32_t UNUSED channel, UNUSED ui
   tim->cr1 |= 1; // Enable the timer
 }
 
+/**
+ * @brief set timer for encoder interface mode (SMS = 011): CH1 and CH2 are
+ *        the quadrature inputs and CNT counts every edge of both, up when
+ *        TI1 leads, wrapping in [0, period). TIM1 is accepted here too.
+ *
+*/
+void timer_start_encoder(int timer, uint32_t period) {
+  if (timer < 1 || timer > 5) return; // Check for valid timer
+  struct tim2_5* tim = timer_base[timer];
+  struct rcc_reg_map *rcc = RCC_BASE;
+  switch (timer)
+  {
+  case 1:
+    rcc->apb2_enr |= TIM1_CLKEN;
+    break;
+  case 2:
+    rcc->apb1_enr |= TIM2_CLKEN;
+    break;
+  case 3:
+    rcc->apb1_enr |= TIM3_CLKEN;
+    break;
+  case 4:
+    rcc->apb1_enr |= TIM4_CLKEN;
+    break;
+  case 5:
+    rcc->apb1_enr |= TIM5_CLKEN;
+    break;
+  default:
+    break;
+  }
+  tim->cr1 &= ~1;
+  // TI1 on IC1, TI2 on IC2, each filtered over 4 samples against bounce
+  tim->ccmr[0] = (ENC_IC_FILTER << 12) | (TIM_CCMR_CC2S_TI2) | (ENC_IC_FILTER << 4) | TIM_CCMR_CC1S_TI1;
+  tim->ccer &= ~(TIM_CCER_CC1P | TIM_CCER_CC2P); // rising = rising, no inversion
+  tim->smcr = (tim->smcr & ~TIM_SMCR_SMS) | TIM_SMCR_SMS_ENCODER3;
+  tim->psc = 0;
+  tim->arr = period - 1;
+  tim->cnt = 0;
+
+  tim->cr1 |= 1; // Enable the timer
+}
+
+/**
+ * @brief start timer as a free-running up-counter at 16 MHz / prescalar for
+ *        timestamps, without interrupts. TIM2 and TIM5 are 32 bits wide.
+ *
+*/
+void timer_start_counter(int timer, uint32_t prescalar) {
+  if (timer < 2 || timer > 5) return; // Check for valid timer
+  struct tim2_5* tim = timer_base[timer];
+  struct rcc_reg_map *rcc = RCC_BASE;
+  switch (timer)
+  {
+  case 2:
+    rcc->apb1_enr |= TIM2_CLKEN;
+    break;
+  case 3:
+    rcc->apb1_enr |= TIM3_CLKEN;
+    break;
+  case 4:
+    rcc->apb1_enr |= TIM4_CLKEN;
+    break;
+  case 5:
+    rcc->apb1_enr |= TIM5_CLKEN;
+    break;
+  default:
+    break;
+  }
+  tim->psc = prescalar - 1;
+  tim->arr = 0xFFFFFFFF;
+  // load PSC now rather than at the first wrap
+  tim->egr = 1;
+  MMIO_WRITTEN(tim->egr);
+  tim->sr &= ~TIM_SR_UIF;
+
+  tim->cr1 |= 1; // Enable the timer
+}
+
 /**
  * @brief dynamically set the duty cycle after you initialize the timer and its PWM mode
 */
@@ -224,13 +311,16 @@ volatile uint8_t ledstate = 0;
  * @param timer      - The timer
 */
 void timer_disable(UNUSED int timer) {
-  if (timer < 2 || timer > 5) return; // Check for valid timer
+  if (timer < 1 || timer > 5) return; // Check for valid timer
   struct tim2_5* tim = timer_base[timer];
   // Disable the timer
   tim->cr1 &= ~1;
   struct rcc_reg_map *rcc = RCC_BASE;
   switch (timer)
   {
+  case 1:
+    rcc->apb2_enr &= ~TIM1_CLKEN;
+    break;
   case 2:
     rcc->apb1_enr &= ~TIM2_CLKEN;
     break;
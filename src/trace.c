@@ -0,0 +1,118 @@
+/**
+ * @file trace.c
+ *
+ * @brief Timestamped input recorder, dumped for replay in the host build
+ *
+ * @date 10/17/2026
+ *
+ * @author Yuhong Yao (yuhongy), Yiying Li (yiyingl4)
+ */
+
+#include <trace.h>
+
+#ifdef TRACE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <arm.h>
+#include <dwt.h>
+
+/** @brief DWT cycles per us */
+#define TRACE_CYCLES_PER_US (configCPU_CLOCK_HZ / 1000000)
+
+/** @brief one input */
+typedef struct {
+    /** @brief DWT cycles since trace_init */
+    uint32_t cycles;
+    /** @brief trace_event_t */
+    uint8_t event;
+    /** @brief what came in */
+    uint8_t data;
+} trace_entry_t;
+
+/** @brief the trace, filled in order */
+static trace_entry_t entries[TRACE_EVENTS];
+/** @brief entries in use */
+static volatile uint32_t count;
+/** @brief events that came after the trace was full */
+static volatile uint32_t dropped;
+
+/** @brief names in the dump, by trace_event_t */
+static const char *const event_names[] = {
+    [TRACE_ENCODER] = "enc",
+    [TRACE_BUTTON] = "button",
+    [TRACE_KEY] = "key",
+    [TRACE_UART] = "uart",
+};
+
+/**
+ * @brief  start the cycle counter from 0 and empty the trace. The replay
+ *         in the host build takes its time from that write too.
+ *
+*/
+void trace_init(void) {
+    dwt_init();
+    uint32_t primask = irq_save();
+    count = 0;
+    dropped = 0;
+    dwt_reset();
+    irq_restore(primask);
+}
+
+/**
+ * @brief  take the timestamp and the slot together with interrupts masked,
+ *         so the trace stays in time order whoever records. PRIMASK, not
+ *         the kernel's BASEPRI: the EXTI handlers record at priority 0.
+ *
+*/
+void trace_record(trace_event_t event, uint8_t data) {
+    uint32_t primask = irq_save();
+    if (count < TRACE_EVENTS) {
+        trace_entry_t *entry = &entries[count];
+        entry->cycles = dwt_cycles();
+        entry->event = event;
+        entry->data = data;
+        count++;
+    } else {
+        dropped++;
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief  the bytes in one go, so they share the timestamp
+ *
+*/
+void trace_record_ring(trace_event_t event, const RingBuffer *rb, uint16_t from, uint16_t len) {
+    uint32_t primask = irq_save();
+    uint32_t now = dwt_cycles();
+    for (uint16_t i = 0; i < len; i++) {
+        if (count < TRACE_EVENTS) {
+            trace_entry_t *entry = &entries[count];
+            entry->cycles = now;
+            entry->event = event;
+            entry->data = rb->buffer[(uint16_t)(from + i) & rb->mask];
+            count++;
+        } else {
+            dropped++;
+        }
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief  print every entry, then the totals. Entries are only ever
+ *         appended, so the ones below count are stable while printing.
+ *
+*/
+void trace_dump(void) {
+    uint32_t n = count;
+    for (uint32_t i = 0; i < n; i++) {
+        printf("trace,%lu,%s,%u\n", (unsigned long)(entries[i].cycles / TRACE_CYCLES_PER_US),
+               event_names[entries[i].event], entries[i].data);
+    }
+    printf("trace,end,%lu,%lu\n", (unsigned long)n, (unsigned long)dropped);
+}
+
+#endif /* TRACE */
@@ -15,13 +15,16 @@
 #include <uart.h>
 #include <nvic.h>
 #include <gpio.h>
+#include <dma.h>
+#include <ring_buffer.h>
+#include <mmio.h>
+#include <dwt.h>
+#include <semihosting.h>
+#include <trace.h>
 
 /** @brief define UNUSE for unuse parameters */
 #define UNUSED __attribute__((unused))
 
-/** @brief set the buffer size */
-#define BUFFER_SIZE (32)
-
 /** @brief The UART register map. */
 struct uart_reg_map {
     volatile uint32_t SR;   /**< Status Register */
@@ -39,9 +42,18 @@ struct uart_reg_map {
 /** @brief Enable Bit for UART Config register */
 #define UART_EN         (1 << 13)
 
-/** @brief Pre calculated UARTDIV value for desired band rate of 115200 bps by default */
+/** @brief Pre calculated UARTDIV value for 115200 bps at 16 MHz, used if the requested rate cannot be generated */
 #define UARTDIV         0x8B
 
+/** @brief Oversampling by 8 instead of 16, doubles the highest baud rate */
+#define UART_CR1_OVER8  (1 << 15)
+
+/** @brief Transmission complete: the last stop bit has left the shift register */
+#define UART_SR_TC      (1 << 6)
+
+/** @brief Largest baud rate error accepted from BRR rounding, in permille */
+#define UART_BAUD_MAX_ERROR_PERMILLE (25)
+
 /** @brief Enable Bit for Transmitter */
 #define UART_TE         (1 << 3)
 
@@ -54,6 +66,18 @@ struct uart_reg_map {
 /** @brief Read data registter not empty */
 #define UART_SR_RXNE    (1 << 5)
 
+/** @brief Idle line detected */
+#define UART_SR_IDLE    (1 << 4)
+
+/** @brief Receive errors: overrun, noise and framing */
+#define UART_SR_ORE     (1 << 3)
+#define UART_SR_NF      (1 << 2)
+#define UART_SR_FE      (1 << 1)
+#define UART_SR_ERRORS  (UART_SR_ORE | UART_SR_NF | UART_SR_FE)
+
+/** @brief set the IDLEIE bit of CR1 in URAT. */
+#define UART_CR1_IDLEIE (1 << 4)
+
 /** @brief set the RXNEIE bit of CR1 in URAT. */
 #define UART_CR1_RXNEIE (1 << 5)
 
@@ -66,85 +90,330 @@ struct uart_reg_map {
 /** @brief set the number of IRQ in URAT. */
 #define UART_IRQ_NUMBER (38)
 
-/** @brief define Ring buffer */
-typedef struct {
-    /** @brief Ring buffer size*/
-    unsigned char buffer[BUFFER_SIZE];
-    /** @brief define Ring buffer head */
-    volatile uint16_t head;
-    /** @brief define Ring buffer tail */
-    volatile uint16_t tail;
-} RingBuffer;
-
-/** @brief define txBuffer. */
-RingBuffer txBuffer;
+/** @brief DMA transmitter enable bit of CR3 */
+#define UART_CR3_DMAT   (1 << 7)
+
+/** @brief DMA receiver enable bit of CR3 */
+#define UART_CR3_DMAR   (1 << 6)
+
+/** @brief CTS enable bit of CR3: TX holds off while the host drives CTS high */
+#define UART_CR3_CTSE   (1 << 9)
+
+/** @brief error interrupt enable bit of CR3 (FE, ORE, NF while DMAR is set) */
+#define UART_CR3_EIE    (1 << 0)
+
+/**
+ * @brief Hardware flow control on PA0 (CTS) and PA1 (RTS). Off by default:
+ *        both pins are keypad lines (COL2 / ROW1) and ADC inputs.
+ */
+#ifndef UART_FLOW_CONTROL
+#define UART_FLOW_CONTROL   (0)
+#endif
+/** @brief USART2_CTS, alternate function 7 */
+#define UART_CTS_PORT   GPIO_A
+#define UART_CTS_PIN    (0)
+/** @brief RTS as a plain output: the USART's own RTS only reacts to DR, which the RX DMA keeps empty */
+#define UART_RTS_PORT   GPIO_A
+#define UART_RTS_PIN    (1)
+
+/** @brief DMA controller serving USART2 */
+#define UART_DMA            (1)
+/** @brief USART2_RX request: DMA1 stream 5, channel 4 */
+#define UART_RX_DMA_STREAM  (5)
+/** @brief USART2_TX request: DMA1 stream 6, channel 4 */
+#define UART_TX_DMA_STREAM  (6)
+/** @brief USART2 request channel on DMA1 */
+#define UART_DMA_CHANNEL    (4)
+/** @brief IRQ number of the RX DMA stream */
+#define UART_RX_DMA_IRQ_NUMBER (DMA1_STREAM0_INT_NUM + UART_RX_DMA_STREAM)
+/** @brief IRQ number of the TX DMA stream */
+#define UART_TX_DMA_IRQ_NUMBER (DMA1_STREAM0_INT_NUM + UART_TX_DMA_STREAM)
+
+/** @brief how long uart_write blocks on a full txQueue before returning a short count */
+#define UART_TX_TIMEOUT_MS  (100)
+
+/** @brief how long uart_set_baud waits for the TX side to drain, in DWT cycles
+ *         so the bound also holds before the scheduler ticks */
+#define UART_BAUD_DRAIN_MS      (500)
+#define UART_BAUD_DRAIN_CYCLES  ((uint32_t)(configCPU_CLOCK_HZ / 1000) * UART_BAUD_DRAIN_MS)
+
+/** @brief NVIC priority of the UART and its DMA streams, low enough to use FreeRTOS FromISR APIs */
+#define UART_IRQ_PRIORITY   (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1)
+
+/** @brief TX ring size in bytes, a power of two; one printf line should fit so lines stay whole */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE (256)
+#endif
+
+/** @brief RX ring size in bytes, a power of two; the RX DMA interrupts every half of it */
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE (128)
+#endif
+
+/** @brief bytes the host may still send after RTS goes high */
+#ifndef UART_RTS_LAG
+#define UART_RTS_LAG        (16)
+#endif
+/**
+ * @brief RTS goes high above this fill level. The ring is only looked at every
+ *        half buffer (HT / TC / IDLE), so there must be room for another half
+ *        plus the host's lag by the time the next look happens.
+ */
+#define UART_RX_HIGH_WATER  (UART_RX_BUFFER_SIZE / 2 - UART_RTS_LAG)
+/** @brief RTS goes low again once uart_read has drained to this level */
+#define UART_RX_LOW_WATER   (UART_RX_BUFFER_SIZE / 4)
+
+/** @brief storage behind txQueue */
+static uint8_t txStorage[UART_TX_BUFFER_SIZE];
+/** @brief storage behind rxBuffer, written directly by the RX DMA */
+static uint8_t rxStorage[UART_RX_BUFFER_SIZE];
+
+/** @brief TX queue, filled by any number of tasks and drained by the TX DMA. */
+MpscRingBuffer txQueue;
 /** @brief define rxBuffer;. */
 RingBuffer rxBuffer;
 
-/** @brief initialize ring buffer as empty by setting both head and tail to 0. */
-void RingBuffer_init(RingBuffer *rb) {
-    rb->head = 0;
-    rb->tail = 0;
+/** @brief number of bytes from txQueue.rb.head the TX DMA currently owns, 0 when idle */
+static volatile uint16_t txDmaLen;
+
+/** @brief link counters, see uart_get_stats */
+static uart_stats_t stats;
+
+/** @brief 1 while RTS is high and the host should be holding off */
+static volatile int rxThrottled;
+
+/** @brief task blocked in uart_read until the RX DMA publishes new bytes */
+static TaskHandle_t volatile rxWaitingTask;
+/** @brief first task blocked in uart_write until the TX DMA frees space */
+static TaskHandle_t volatile txWaitingTask;
+
+/**
+ * @brief wake the task parked in *waiter, if any, with a direct-to-task notification.
+ *        Only call from the UART / UART DMA interrupts.
+ */
+static void uart_notify_from_isr(TaskHandle_t volatile *waiter) {
+    TaskHandle_t task = *waiter;
+    if (task != NULL) {
+        BaseType_t woken = pdFALSE;
+        *waiter = NULL;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
 }
 
-/** @brief check if the ring buffer is empty, if head equal to tail then it can be considered as empty. */
-int RingBuffer_isEmpty(RingBuffer *rb) {
-    return rb->head == rb->tail;
+/**
+ * @brief park the calling task until the RX interrupts publish data. The waiter
+ *        is registered before the emptiness re-check so an event landing in
+ *        between is not lost. Returns at once if the scheduler is not running.
+ */
+static void uart_wait_rx(void) {
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return;
+    }
+    rxWaitingTask = xTaskGetCurrentTaskHandle();
+    if (RingBuffer_isEmpty(&rxBuffer)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    rxWaitingTask = NULL;
 }
 
-/** @brief check if buffer is full, since mod or divid will take a lot cycles, use masks to determine if full when tail wrapped to head. */
-int RingBuffer_isFull(RingBuffer *rb) {
-    
-    return (((rb->tail + 1) & (BUFFER_SIZE - 1)) == rb->head); 
+/**
+ * @brief park the calling task until len bytes can be reserved in txQueue.
+ *        Only one task owns the notification slot; any other writer that is
+ *        stuck at the same time re-checks once per tick instead.
+ *        Returns 0 once there is room, -1 if there still is not after the timeout.
+ */
+static int uart_wait_tx(uint16_t len, TickType_t timeout) {
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return -1;
+    }
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TimeOut_t start;
+    vTaskSetTimeOutState(&start);
+
+    while (MpscRingBuffer_free(&txQueue) < len) {
+        if (xTaskCheckForTimeOut(&start, &timeout) != pdFALSE) {
+            return -1;
+        }
+        taskENTER_CRITICAL();
+        int owner = (txWaitingTask == NULL);
+        if (owner) {
+            txWaitingTask = self;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!owner) {
+            vTaskDelay(1);
+            continue;
+        }
+        if (MpscRingBuffer_free(&txQueue) < len) {
+            ulTaskNotifyTake(pdTRUE, timeout);
+        }
+        taskENTER_CRITICAL();
+        if (txWaitingTask == self) {
+            txWaitingTask = NULL;
+        }
+        taskEXIT_CRITICAL();
+    }
+    return 0;
 }
 
-/** @brief add a byte to the buffer at tail. */
-int RingBuffer_Write(RingBuffer *rb, char data) {
-    int status;
+/**
+ * @brief hand the contiguous published span starting at txQueue.rb.head to the
+ *        TX DMA stream. head only moves once the transfer completes, so producers
+ *        can never reserve bytes in flight. Caller must mask the UART DMA interrupt.
+ */
+static void uart_tx_dma_kick(void) {
+    if (txDmaLen != 0) {
+        return;
+    }
+#ifdef SEMIHOSTING
+    // the semihosting host takes each span on the spot, nothing is in flight
+    uint8_t *data;
+    uint16_t n;
+    while ((n = RingBuffer_PeekRead(&txQueue.rb, &data)) != 0) {
+        semihosting_write((const char *)data, n);
+        RingBuffer_CommitRead(&txQueue.rb, n);
+    }
+    return;
+#endif
+    // the span stops at the end of the storage, the wrapped part is chained on transfer-complete
+    uint8_t *span;
+    uint16_t len = RingBuffer_PeekRead(&txQueue.rb, &span);
+    if (len == 0) {
+        return;
+    }
+
+    txDmaLen = len;
+    dma_stream_start(UART_DMA, UART_TX_DMA_STREAM, span, len);
+}
 
-    // taskENTER_CRITICAL();
-    if (!RingBuffer_isFull(rb)) {
-        rb->buffer[rb->tail] = data;
-        rb->tail = (rb->tail + 1) & (BUFFER_SIZE - 1);
-        status = 0; // Success
-    } else {
-        status = -1; // Buffer is full
+/**
+ * @brief raise or drop RTS from the RX ring fill level (RTS high = stop).
+ *        Caller must mask the UART interrupts.
+ */
+static void uart_rx_flow_update(void) {
+#if UART_FLOW_CONTROL
+    uint16_t used = RingBuffer_used(&rxBuffer);
+    if (!rxThrottled && used > UART_RX_HIGH_WATER) {
+        gpio_set(UART_RTS_PORT, UART_RTS_PIN);
+        rxThrottled = 1;
+        stats.rx_throttled++;
+    } else if (rxThrottled && used <= UART_RX_LOW_WATER) {
+        gpio_clr(UART_RTS_PORT, UART_RTS_PIN);
+        rxThrottled = 0;
     }
-    // taskEXIT_CRITICAL(); // Exit the critical section
+#endif
+}
 
-    return status;
+/**
+ * @brief count bytes the TX side had to give up on, from task context
+ */
+static void uart_count_tx_drop(uint32_t len) {
+    taskENTER_CRITICAL();
+    stats.tx_dropped += len;
+    taskEXIT_CRITICAL();
 }
 
-/** @brief read the buffer from head and advance the head. */
-int RingBuffer_Read(RingBuffer *rb, char *data) {
-    int status;
+/**
+ * @brief publish how far the RX DMA has written into rxBuffer. The stream runs
+ *        in circular mode over rxBuffer.buffer, so the write index is derived
+ *        from NDTR. Called from the IDLE, half-transfer and transfer-complete
+ *        events, which bounds the gap between calls to half the buffer.
+ */
+static void uart_rx_dma_update(void) {
+    uint16_t pos = rxBuffer.size - dma_stream_remaining(UART_DMA, UART_RX_DMA_STREAM);
+    uint16_t moved = (pos - rxBuffer.tail) & rxBuffer.mask;
+
+    if (RingBuffer_used(&rxBuffer) + moved > rxBuffer.size) {
+        // the reader was lapped: the oldest bytes are already overwritten.
+        // uart_get_byte reads with this IRQ masked, so neither update of head is lost
+        uint16_t lost = RingBuffer_used(&rxBuffer) + moved - rxBuffer.size;
+        stats.rx_dropped += lost;
+        rxBuffer.head = rxBuffer.head + lost;
+    }
+    trace_record_ring(TRACE_UART, &rxBuffer, rxBuffer.tail, moved);
+    RingBuffer_CommitWrite(&rxBuffer, moved);
 
-    // taskENTER_CRITICAL();
-    if (!RingBuffer_isEmpty(rb)) {
-        *data = rb->buffer[rb->head];
-        rb->head = (rb->head + 1) & (BUFFER_SIZE - 1);
-        status = 0; // Success
-    } else {
-        status = -1; // Buffer is empty
+    if (RingBuffer_used(&rxBuffer) > stats.rx_peak) {
+        stats.rx_peak = RingBuffer_used(&rxBuffer);
     }
-    // taskEXIT_CRITICAL(); // Exit the critical section
+    uart_rx_flow_update();
 
-    return status;
+    if (moved != 0) {
+        uart_notify_from_isr(&rxWaitingTask);
+    }
 }
 
+/**
+ * @brief current APB1 clock, the USART2 kernel clock: HSI through the AHB and
+ *        APB1 prescalers set in RCC cfgr.
+ */
+static uint32_t uart_pclk(void) {
+    static const uint8_t ahb_shift[8] = {1, 2, 3, 4, 6, 7, 8, 9};
+    struct rcc_reg_map *rcc = RCC_BASE;
+    uint32_t hpre = (rcc->cfgr & RCC_CFGR_HPRE_MASK) >> RCC_CFGR_HPRE_POS;
+    uint32_t ppre1 = (rcc->cfgr & RCC_CFGR_PPRE1_MASK) >> RCC_CFGR_PPRE1_POS;
+    uint32_t hclk = HSI_CLOCK_HZ;
+
+    if (hpre & 0x8) {
+        hclk >>= ahb_shift[hpre & 0x7];
+    }
+    if (ppre1 & 0x4) {
+        return hclk >> ((ppre1 & 0x3) + 1);
+    }
+    return hclk;
+}
+
+/**
+ * @brief work out BRR and the oversampling mode for baud at the current APB1
+ *        clock. fck / baud, rounded, is USARTDIV in 1/16ths (OVER16) or in
+ *        1/8ths (OVER8), so both modes have the same rounding error and
+ *        OVER16 is kept whenever it reaches the rate for its better noise
+ *        margin. Returns -1 if the rate is out of range or too far off.
+ */
+static int uart_compute_brr(int baud, uint32_t *brr, uint32_t *over8) {
+    if (baud <= 0) {
+        return -1;
+    }
+    uint32_t fck = uart_pclk();
+    uint32_t div = (fck + (uint32_t)baud / 2) / (uint32_t)baud;
+
+    if (div >= 16 && div <= 0xFFFF) {
+        *brr = div;
+        *over8 = 0;
+    } else if (div >= 8 && div < 16) {
+        // the fraction field is only 3 bits wide with OVER8, bit 3 must stay clear
+        *brr = ((div & ~7U) << 1) | (div & 7U);
+        *over8 = UART_CR1_OVER8;
+    } else {
+        return -1;
+    }
+
+    uint32_t actual = fck / div;
+    uint32_t error = (actual > (uint32_t)baud) ? actual - (uint32_t)baud : (uint32_t)baud - actual;
+    if (error * 1000 > (uint32_t)baud * UART_BAUD_MAX_ERROR_PERMILLE) {
+        return -1;
+    }
+    return 0;
+}
 
 /**
  * @brief uart_init: UART initialization function
  * baud  - baud rate
  */
-void uart_init(UNUSED int baud) {
+void uart_init(int baud) {
     //init ring buffer
-    RingBuffer_init(&txBuffer);
-    RingBuffer_init(&rxBuffer);
+    MpscRingBuffer_init(&txQueue, txStorage, UART_TX_BUFFER_SIZE);
+    RingBuffer_init(&rxBuffer, rxStorage, UART_RX_BUFFER_SIZE);
 
     if (baud == 0) {
         return;
     }
+#ifdef SEMIHOSTING
+    // console through the semihosting host, USART2 stays off
+    return;
+#endif
     struct uart_reg_map *uart = UART2_BASE;
     // Reset and Clock Control
     struct rcc_reg_map *rcc = RCC_BASE;
@@ -154,22 +423,129 @@ void uart_init(UNUSED int baud) {
     gpio_init(GPIO_A, 3, MODE_ALT, OUTPUT_OPEN_DRAIN, OUTPUT_SPEED_LOW, PUPD_NONE, ALT7);       /* PA_2 for RX line UART2 */
     
     // Initialize UART to the desired Baud Rate
-    uart->BRR = UARTDIV;
+    uint32_t brr, over8;
+    if (uart_compute_brr(baud, &brr, &over8) != 0) {
+        brr = UARTDIV;
+        over8 = 0;
+    }
+    uart->BRR = brr;
+    uart->CR1 = (uart->CR1 & ~UART_CR1_OVER8) | over8;
+    // TX goes memory -> DR through DMA, one interrupt per contiguous span
+    txDmaLen = 0;
+    dma_stream_init(UART_DMA, UART_TX_DMA_STREAM, UART_DMA_CHANNEL, &uart->DR,
+                    DMA_SxCR_DIR_M2P | DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE);
+    // RX runs forever: DR -> rxBuffer.buffer in circular mode, the ring tail
+    // is refreshed on idle line and on every half buffer
+    dma_stream_init(UART_DMA, UART_RX_DMA_STREAM, UART_DMA_CHANNEL, &uart->DR,
+                    DMA_SxCR_DIR_P2M | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_HTIE | DMA_SxCR_TCIE | DMA_SxCR_TEIE);
+    dma_stream_start(UART_DMA, UART_RX_DMA_STREAM, rxBuffer.buffer, rxBuffer.size);
+    uart->CR3 |= (UART_CR3_DMAT | UART_CR3_DMAR | UART_CR3_EIE);
+#if UART_FLOW_CONTROL
+    // CTS pauses the TX DMA in hardware; RTS starts low, ready to receive
+    gpio_init(UART_CTS_PORT, UART_CTS_PIN, MODE_ALT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_PULL_DOWN, ALT7);
+    gpio_init(UART_RTS_PORT, UART_RTS_PIN, MODE_GP_OUTPUT, OUTPUT_PUSH_PULL, OUTPUT_SPEED_LOW, PUPD_NONE, ALT0);
+    gpio_clr(UART_RTS_PORT, UART_RTS_PIN);
+    rxThrottled = 0;
+    uart->CR3 |= UART_CR3_CTSE;
+#endif
+    nvic_set_priority(UART_TX_DMA_IRQ_NUMBER, UART_IRQ_PRIORITY);
+    nvic_irq(UART_TX_DMA_IRQ_NUMBER, IRQ_ENABLE);
+    nvic_set_priority(UART_RX_DMA_IRQ_NUMBER, UART_IRQ_PRIORITY);
+    nvic_irq(UART_RX_DMA_IRQ_NUMBER, IRQ_ENABLE);
     // UART Control Registers
+    nvic_set_priority(UART_IRQ_NUMBER, UART_IRQ_PRIORITY);
     nvic_irq(UART_IRQ_NUMBER, IRQ_ENABLE);
-    uart->CR1 |= (UART_TE | UART_RE | UART_EN | UART_CR1_RXNEIE);
+    uart->CR1 |= (UART_TE | UART_RE | UART_EN | UART_CR1_IDLEIE);
     return;
 }
 
+/**
+ * @brief start the TX DMA if it is idle, from task context
+ */
+static void uart_tx_start(void) {
+    taskENTER_CRITICAL();
+    uart_tx_dma_kick();
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief copy len bytes into txQueue as one reservation, so they go out on the
+ *        wire back to back even when other tasks are writing at the same time.
+ *        Returns -1 without copying anything if there is not room for all of it.
+ */
+static int uart_tx_enqueue(const char *ptr, uint16_t len) {
+    uint16_t start;
+    if (MpscRingBuffer_Reserve(&txQueue, len, &start) != 0) {
+        return -1;
+    }
+    MpscRingBuffer_Fill(&txQueue, start, ptr, len);
+    MpscRingBuffer_Publish(&txQueue);
+    uart_tx_start();
+    return 0;
+}
+
+/**
+ * @brief uart_check_baud: 0 if baud can be generated from the current APB1
+ *        clock within UART_BAUD_MAX_ERROR_PERMILLE, -1 otherwise
+ */
+int uart_check_baud(int baud) {
+    uint32_t brr, over8;
+    return uart_compute_brr(baud, &brr, &over8);
+}
+
+/**
+ * @brief uart_set_baud: switch the link to another rate at runtime.
+ *        Everything already queued goes out at the old rate first, so a
+ *        reply like "OK" reaches the host before the switch. The receiver
+ *        is briefly disabled; bytes arriving during the switch are lost.
+ *        Returns -1, leaving the rate alone, if baud cannot be generated or
+ *        if the TX side does not drain within UART_BAUD_DRAIN_MS (other
+ *        tasks keep queuing, or interrupts are still masked before the
+ *        scheduler starts).
+ */
+int uart_set_baud(int baud) {
+    struct uart_reg_map *uart = UART2_BASE;
+    uint32_t brr, over8;
+
+    if (uart_compute_brr(baud, &brr, &over8) != 0) {
+        return -1;
+    }
+#ifdef SEMIHOSTING
+    return 0;
+#endif
+
+    // drain the queue and the DMA, then wait for the last stop bit
+    dwt_init();
+    uint32_t start = dwt_cycles();
+    while (MpscRingBuffer_free(&txQueue) != txQueue.rb.size || txDmaLen != 0 || !(uart->SR & UART_SR_TC)) {
+        if (dwt_cycles() - start >= UART_BAUD_DRAIN_CYCLES) {
+            return -1;
+        }
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+            vTaskDelay(1);
+        }
+    }
+
+    // BRR and OVER8 may only change while UE is clear
+    taskENTER_CRITICAL();
+    uart->CR1 &= ~UART_EN;
+    uart->BRR = brr;
+    uart->CR1 = (uart->CR1 & ~UART_CR1_OVER8) | over8;
+    uart->CR1 |= UART_EN;
+    taskEXIT_CRITICAL();
+    return 0;
+}
+
 /**
  * @brief uart_put_byte: transmits a byte over UART
  * c  - character to be sent
  */
 int uart_put_byte(UNUSED char c) {
-    struct uart_reg_map *uart = UART2_BASE;
-    int status = RingBuffer_Write(&txBuffer, c);
-    uart->CR1 |= UART_CR1_TXEIE;
-    return status;
+    if (uart_tx_enqueue(&c, 1) != 0) {
+        uart_count_tx_drop(1);
+        return -1;
+    }
+    return 0;
 }
 
 /**
@@ -178,7 +554,16 @@ int uart_put_byte(UNUSED char c) {
  */
 int uart_get_byte(UNUSED char *c) {
     char data;
+    // uart_rx_dma_update moves head too when the DMA laps the reader
+    taskENTER_CRITICAL();
     int status = RingBuffer_Read(&rxBuffer, &data);
+    taskEXIT_CRITICAL();
+    if (rxThrottled) {
+        // let the host resume once we are below the low watermark
+        taskENTER_CRITICAL();
+        uart_rx_flow_update();
+        taskEXIT_CRITICAL();
+    }
     if (status == 0) {
         *c = data;
         return 0;
@@ -188,6 +573,10 @@ int uart_get_byte(UNUSED char *c) {
 
 /**
  * @brief uart_write: support writing to stdout and return −1 if this is not the case
+ *        Safe to call from any number of tasks without a lock: each call of up
+ *        to UART_TX_BUFFER_SIZE bytes is queued whole. Blocks while there is not
+ *        room for it; if none frees up within UART_TX_TIMEOUT_MS the bytes
+ *        written so far are returned.
  * 
  */
 int uart_write(UNUSED int file, UNUSED char *ptr, UNUSED int len) {
@@ -195,14 +584,43 @@ int uart_write(UNUSED int file, UNUSED char *ptr, UNUSED int len) {
         return -1;
     }
 
-    for (int i = 0; i < len; i++) {
-        if (uart_put_byte(ptr[i]) == -1) {
-            return -1;
+    int done = 0;
+    while (done < len) {
+        // longer writes go out a ring at a time and may interleave between chunks
+        uint16_t chunk = (len - done > txQueue.rb.size) ? txQueue.rb.size : (uint16_t)(len - done);
+        while (uart_tx_enqueue(ptr + done, chunk) != 0) {
+            if (uart_wait_tx(chunk, pdMS_TO_TICKS(UART_TX_TIMEOUT_MS)) != 0) {
+                uart_count_tx_drop(len - done);
+                return (done > 0) ? done : -1;
+            }
         }
+        done += chunk;
     }
     return len;
 }
 
+/**
+ * @brief uart_write_nonblock: queue len bytes as one unit or not at all, for
+ *        callers such as the control loop that must never block on the link.
+ *        Returns 0, or -1 if there is not room for all of it right now.
+ */
+int uart_write_nonblock(const char *ptr, int len) {
+    if (len < 0 || len > txQueue.rb.size || uart_tx_enqueue(ptr, (uint16_t)len) != 0) {
+        uart_count_tx_drop((len > 0) ? len : 0);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief uart_get_stats: snapshot of the link counters
+ */
+void uart_get_stats(uart_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
 /**
  * @brief uart_read: support reading from stdin and return −1 if this is not the case
  * 
@@ -216,7 +634,8 @@ int uart_read(UNUSED int file, char *ptr, int len) {
     char c;
     while (1) {  // Keep reading until we get a newline
         if (uart_get_byte(&c) != 0) {
-            continue;  // If no byte was read, try again
+            uart_wait_rx();  // sleep until the RX interrupts publish more data
+            continue;
         }
         
         if (c == 4) {
@@ -243,38 +662,64 @@ int uart_read(UNUSED int file, char *ptr, int len) {
 
 
 /**
- * @brief uart_irq_handler: to handle the interrupt request (both receive and transmit)
- * 
+ * @brief uart_tx_dma_irq_handler: DMA1 stream 6 interrupt, one per transmitted span.
+ *        Releases the span to the producers and chains the next one (the
+ *        wrap-around segment or whatever was queued meanwhile).
+ */
+void uart_tx_dma_irq_handler() {
+    uint32_t flags = dma_get_flags(UART_DMA, UART_TX_DMA_STREAM);
+    dma_clear_flags(UART_DMA, UART_TX_DMA_STREAM, flags);
+
+    if (flags & (DMA_TCIF | DMA_TEIF)) {
+        RingBuffer_CommitRead(&txQueue.rb, txDmaLen);
+        txDmaLen = 0;
+        uart_tx_dma_kick();
+        uart_notify_from_isr(&txWaitingTask);
+    }
+
+    nvic_clear_pending(UART_TX_DMA_IRQ_NUMBER);
+}
+
+/**
+ * @brief uart_rx_dma_irq_handler: DMA1 stream 5 interrupt at half and full buffer
+ *
+ */
+void uart_rx_dma_irq_handler() {
+    uint32_t flags = dma_get_flags(UART_DMA, UART_RX_DMA_STREAM);
+    dma_clear_flags(UART_DMA, UART_RX_DMA_STREAM, flags);
+
+    if (flags & (DMA_HTIF | DMA_TCIF)) {
+        uart_rx_dma_update();
+    }
+
+    nvic_clear_pending(UART_RX_DMA_IRQ_NUMBER);
+}
+
+/**
+ * @brief uart_irq_handler: idle line interrupt, the end of a burst that did not
+ *        fill half of the RX buffer, and the receive error interrupt (EIE).
+ *        Both directions move data through DMA.
+ *
  */
 void uart_irq_handler() {
     struct uart_reg_map *uart = UART2_BASE;
-    int transmitCount = 0;
-    int receiveCount = 0;
-
-    // Handle Transmission
-    while ((uart->SR & UART_SR_TXE) && (transmitCount < 16)) {
-        if (!RingBuffer_isEmpty(&txBuffer)) {
-            char data;
-            if (RingBuffer_Read(&txBuffer, &data) == 0) {
-                uart->DR = data;
-                transmitCount++;
-            }
-        } else {
-            uart->CR1 &= ~UART_CR1_TXEIE;
-            break;
-        }
-    }
+    uint32_t sr = uart->SR;
 
-    // Handle Reception
-    while ((uart->SR & UART_SR_RXNE) && (receiveCount < 16)) {
-        char data = uart->DR; // Reading DR clears the RXNE flag
-        if (!RingBuffer_isFull(&rxBuffer)) {
-            RingBuffer_Write(&rxBuffer, data);
-            receiveCount++;
-        } else {
-            // Buffer is full, can't receive more data, break the loop
-            break;
-        }
+    if (sr & (UART_SR_IDLE | UART_SR_ERRORS)) {
+        (void)uart->DR; // SR then DR read clears IDLE and the error flags
+        MMIO_READ(uart->DR);
+    }
+    if (sr & UART_SR_ORE) {
+        stats.overrun++;
+    }
+    if (sr & UART_SR_FE) {
+        stats.framing++;
+    }
+    if (sr & UART_SR_NF) {
+        stats.noise++;
+    }
+    if (sr & UART_SR_IDLE) {
+        uart_rx_dma_update();
     }
 
     nvic_clear_pending(UART_IRQ_NUMBER);